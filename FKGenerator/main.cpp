@@ -0,0 +1,237 @@
+/*
+FKGenerator: emit forward kinematics and Jacobian kernels specialized for one skeleton
+
+Usage: FKGenerator <ASF file> <scale> <output .cpp>
+
+The generated translation unit bakes the hierarchy, DOFs and rest transforms in as constants, unrolls forward
+kinematics bone by bone, emits one unrolled Jacobian routine per IK chain and registers itself with
+kinematics::registerGeneratedSolver(). acclaim::Motion selects it whenever the loaded skeleton has the same
+fingerprint, otherwise the generic solver is used.
+*/
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+
+#include "acclaim/skeleton.h"
+#include "util/filesystem.h"
+
+namespace {
+// Print a double so that it parses back to exactly the same value
+std::string literal(double value) {
+    std::ostringstream oss;
+    oss << std::setprecision(17) << value;
+    std::string str = oss.str();
+    if (str.find_first_of(".eEn") == std::string::npos) str += ".0";
+    return str;
+}
+
+// Visit bones parent first, so every bone's parent is evaluated before the bone itself
+void collectBones(const acclaim::Bone* bone, std::vector<const acclaim::Bone*>& order) {
+    order.push_back(bone);
+    for (const acclaim::Bone* child = bone->child; child != nullptr; child = child->sibling) {
+        collectBones(child, order);
+    }
+}
+
+bool isIdentity(const Eigen::Quaterniond& rotation) {
+    return rotation.coeffs() == Eigen::Quaterniond::Identity().coeffs();
+}
+
+void writeConstants(std::ostream& out, const acclaim::Skeleton& skeleton) {
+    const int bone_num = skeleton.getBoneNum();
+    out << "constexpr std::uint64_t fingerprint = 0x" << std::hex << skeleton.getFingerprint() << std::dec << "ULL;\n";
+    out << "constexpr int bone_num = " << bone_num << ";\n";
+    out << "// Rotation from each bone's local coordinate system to its parent's (rot_parent_current), as x, y, z, w\n";
+    out << "constexpr double rest_rotations[bone_num][4] = {\n";
+    for (int i = 0; i < bone_num; ++i) {
+        const acclaim::Bone* bone = skeleton.getBonePointer(i);
+        const Eigen::Vector4d rest = bone->rot_parent_current.coeffs();
+        out << "    {";
+        for (int k = 0; k < 4; ++k) out << (k ? ", " : "") << literal(rest[k]);
+        out << "},  // " << bone->name << "\n";
+    }
+    out << "};\n";
+    out << "// Offset from bone's start to its end in local coordinate (dir * length)\n";
+    out << "constexpr double offsets[bone_num][3] = {\n";
+    for (int i = 0; i < bone_num; ++i) {
+        const acclaim::Bone* bone = skeleton.getBonePointer(i);
+        const Eigen::Vector4d offset = bone->dir * bone->length;
+        out << "    {" << literal(offset[0]) << ", " << literal(offset[1]) << ", " << literal(offset[2]) << "},  // "
+            << bone->name << "\n";
+    }
+    out << "};\n\n";
+}
+
+void writeForwardSolver(std::ostream& out, const std::vector<const acclaim::Bone*>& order) {
+    out << "void generatedForwardSolver(const acclaim::Posture& posture, acclaim::Pose& pose) {\n";
+    out << "    if (pose.transforms.size() < bone_num) pose = acclaim::Pose(bone_num);\n";
+    out << "    util::rotateDegreeZYX(posture.bone_rotations, pose.local_rotations);\n";
+    for (const acclaim::Bone* bone : order) {
+        const int i = bone->idx;
+        const bool has_offset = (bone->dir * bone->length).head<3>().squaredNorm() != 0.0;
+        out << "    {\n";
+        out << "        // " << bone->name << "\n";
+        // Accumulate parent rotation, rest rotation and the local rotation from the DOF channels
+        std::string expression = bone->parent == nullptr
+                                     ? std::string()
+                                     : "pose.transforms[" + std::to_string(bone->parent->idx) + "].rotation";
+        auto append = [&expression](const std::string& term) {
+            expression = expression.empty() ? term : expression + " * " + term;
+        };
+        if (!isIdentity(bone->rot_parent_current)) {
+            append("Eigen::Map<const Eigen::Quaterniond>(rest_rotations[" + std::to_string(i) + "])");
+        }
+        // Channels without DOF are zero, so the batched ZYX rotation equals applying only the DOF axes
+        if (bone->dofrz || bone->dofry || bone->dofrx) {
+            append("pose.local_rotations[" + std::to_string(i) + "]");
+        }
+        if (expression.empty()) expression = "Eigen::Quaterniond::Identity()";
+        out << "        pose.transforms[" << i << "].rotation = " << expression << ";\n";
+        if (bone->parent == nullptr) {
+            out << "        pose.transforms[" << i << "].translation = posture.bone_translations[" << i
+                << "].head<3>();\n";
+        } else {
+            out << "        pose.transforms[" << i << "].translation = pose.end_positions[" << bone->parent->idx
+                << "].head<3>();\n";
+        }
+        if (has_offset) {
+            out << "        pose.end_positions[" << i << "] << pose.transforms[" << i << "] * Eigen::Vector3d(offsets["
+                << i << "]), 0.0;\n";
+        } else {
+            out << "        pose.end_positions[" << i << "] << pose.transforms[" << i << "].translation, 0.0;\n";
+        }
+        out << "    }\n";
+    }
+    out << "}\n\n";
+}
+
+// Bones of the IK chain from end up to start, or up to the root if start is not an ancestor of end, which is
+// the chain inverseJacobianIKSolver walks
+std::vector<const acclaim::Bone*> chainBones(const acclaim::Bone* start, const acclaim::Bone* end) {
+    std::vector<const acclaim::Bone*> chain{end};
+    for (const acclaim::Bone* bone = end; bone != start && bone->parent != nullptr; bone = bone->parent) {
+        chain.push_back(bone->parent);
+    }
+    return chain;
+}
+
+std::string chainName(const std::vector<const acclaim::Bone*>& chain) {
+    return "chainJacobian" + std::to_string(chain.front()->idx) + "_" + std::to_string(chain.back()->idx);
+}
+
+// One unrolled routine per distinct chain, three columns per bone starting at the end bone
+void writeChainJacobians(std::ostream& out, const acclaim::Skeleton& skeleton) {
+    const int bone_num = skeleton.getBoneNum();
+    const char* units[3] = {"UnitX()", "UnitY()", "UnitZ()"};
+    for (int end = 0; end < bone_num; ++end) {
+        // Walking up from end, every ancestor (and end itself) starts a distinct chain
+        for (const acclaim::Bone* start = skeleton.getBonePointer(end); start != nullptr; start = start->parent) {
+            const std::vector<const acclaim::Bone*> chain = chainBones(start, skeleton.getBonePointer(end));
+            const bool empty = std::none_of(chain.begin(), chain.end(), [](const acclaim::Bone* bone) {
+                return bone->dofrx || bone->dofry || bone->dofrz;
+            });
+            // Parameters stay unnamed when no bone of the chain has a rotational DOF
+            out << "void " << chainName(chain) << "(const acclaim::Pose&" << (empty ? "" : " pose")
+                << ", const Eigen::Vector4d&" << (empty ? "" : " target_pos") << ",\n"
+                << "                   Eigen::Matrix4Xd&" << (empty ? "" : " Jacobian") << ") {\n";
+            for (std::size_t i = 0; i < chain.size(); ++i) {
+                const acclaim::Bone* bone = chain[i];
+                const bool dofs[3] = {bone->dofrx, bone->dofry, bone->dofrz};
+                const int dof_num = dofs[0] + dofs[1] + dofs[2];
+                if (dof_num == 0) continue;
+                const std::string transform = "pose.transforms[" + std::to_string(bone->idx) + "]";
+                out << "    {\n";
+                out << "        // " << bone->name << "\n";
+                out << "        const Eigen::Vector3d arm = target_pos.head<3>() - " << transform << ".translation;\n";
+                // One axis is cheaper to rotate directly, more share the rotation matrix
+                if (dof_num > 1) {
+                    out << "        const Eigen::Matrix3d rotation = " << transform
+                        << ".rotation.toRotationMatrix();\n";
+                }
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (!dofs[axis]) continue;
+                    out << "        Jacobian.col(" << 3 * i + axis << ").head<3>() = ";
+                    if (dof_num > 1) {
+                        out << "rotation.col(" << axis << ").cross(arm);\n";
+                    } else {
+                        out << "(" << transform << ".rotation * Eigen::Vector3d::" << units[axis] << ").cross(arm);\n";
+                    }
+                }
+                out << "    }\n";
+            }
+            out << "}\n\n";
+        }
+    }
+    out << "// Indexed by end bone * bone_num + start bone\n";
+    out << "constexpr ChainJacobian chain_jacobians[bone_num * bone_num] = {\n";
+    for (int end = 0; end < bone_num; ++end) {
+        out << "    // " << skeleton.getBonePointer(end)->name << "\n";
+        for (int start = 0; start < bone_num; ++start) {
+            const std::string name =
+                chainName(chainBones(skeleton.getBonePointer(start), skeleton.getBonePointer(end)));
+            out << (start % 4 == 0 ? "    " : " ") << "&" << name << ",";
+            if (start % 4 == 3 || start == bone_num - 1) out << "\n";
+        }
+    }
+    out << "};\n\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <ASF file> <scale> <output .cpp>" << std::endl;
+        return 1;
+    }
+    const util::fs::path asf_file(argv[1]);
+    const double scale = std::strtod(argv[2], nullptr);
+    acclaim::Skeleton skeleton(asf_file, scale);
+    // An incomplete skeleton would bake a solver nothing matches, fail the build instead
+    if (!skeleton.isLoaded()) {
+        std::cerr << "Failed to load " << asf_file << std::endl;
+        return 1;
+    }
+    std::vector<const acclaim::Bone*> order;
+    collectBones(skeleton.getBonePointer(acclaim::Skeleton::root_idx()), order);
+
+    std::ostringstream out;
+    out << "// Generated by FKGenerator from " << asf_file.filename().string() << " (scale " << literal(scale)
+        << "), do not edit\n";
+    out << "#include <cstdint>\n\n";
+    out << "#include \"Eigen/Core\"\n#include \"Eigen/Geometry\"\n\n";
+    out << "#include \"acclaim/pose.h\"\n#include \"acclaim/posture.h\"\n";
+    out << "#include \"simulation/kinematics.h\"\n#include \"util/helper.h\"\n\n";
+    out << "namespace kinematics {\nnamespace {\n";
+    writeConstants(out, skeleton);
+    writeForwardSolver(out, order);
+    writeChainJacobians(out, skeleton);
+    out << "const GeneratedSolver solver{fingerprint, &generatedForwardSolver, bone_num, chain_jacobians};\n";
+    out << "[[maybe_unused]] const bool registered = registerGeneratedSolver(&solver);\n";
+    out << "}  // namespace\n}  // namespace kinematics\n";
+
+    const util::fs::path output_file(argv[3]);
+    // Only touch the output when it changes to avoid needless rebuilds
+    {
+        std::ifstream previous(output_file);
+        std::ostringstream previous_content;
+        previous_content << previous.rdbuf();
+        if (previous && previous_content.str() == out.str()) return 0;
+    }
+    if (output_file.has_parent_path()) util::fs::create_directories(output_file.parent_path());
+    std::ofstream output(output_file);
+    if (!output) {
+        std::cerr << "Failed to open " << output_file << std::endl;
+        return 1;
+    }
+    output << out.str();
+    std::cout << "Generated kinematics solver for " << skeleton.getBoneNum() << " bones in " << output_file.string()
+              << std::endl;
+    return 0;
+}
@@ -5,9 +5,12 @@ First step: Search TODO comments to find the methods that you need to implement.
     - src/simulation/kinematics.cpp
 */
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "Eigen/Core"
 #include "GLFW/glfw3.h"
@@ -41,18 +44,39 @@ bool isUsingCameraPanel = false;
 bool isUsingFreeCamera = false;
 // Mouse is disabled?
 bool isMouseBinded = false;
-// IK motion
+// IK motion, shows the poses solved by simulation
 std::unique_ptr<acclaim::Motion> IK;
-// Reset motion without reload
-std::unique_ptr<acclaim::Motion> IK_backup;
+// Solves IK off the render thread, also keeps the motion for reset without reload
+std::unique_ptr<kinematics::SimulationThread> simulation;
 // IK "root" bone
 int start_bone = 11;
 // IK "touch" bone
 int end_bone = 29;
 // IK is stable?
 bool isStable = true;
+// Draw the skinned character instead of one cylinder per bone
+bool isUsingSkin = true;
+// Render offscreen without UI and exit, for machines without a display
+bool isHeadless = false;
+// Frames to render in headless mode, the last one is saved to headlessOutput
+int headlessFrames = 1;
+util::fs::path headlessOutput = "headless.ppm";
+// Folder of the PNG sequence of every rendered frame, empty to not capture
+util::fs::path captureFolder;
 }  // namespace
 
+/**
+ * @brief Read command line options:
+ *     --headless              render offscreen without a window or UI
+ *     --frames <count>        frames to render in headless mode (default 1)
+ *     --output <file.ppm>     image of the last headless frame (default headless.ppm)
+ *     --size <width> <height> framebuffer size (default 1024 768)
+ *     --capture <folder>      save every frame without UI to folder/frame_00000.png, ...
+ *
+ * @return False if the options are invalid
+ */
+bool parseArguments(int argc, char** argv);
+
 /**
  * @brief When resizing window, we need to update viewport and camera's aspect
  * ratio.
@@ -98,14 +122,29 @@ void cameraPanel(GLFWwindow* window);
  */
 void renderUI(GLFWwindow* window, kinematics::Ball* ball);
 
-int main() {
+int main(int argc, char** argv) {
+    if (!parseArguments(argc, argv)) return 1;
     GLFWwindow* window = initialize();
     // No window created
     if (window == nullptr) return 1;
+    // Headless frames are drawn here instead of the (possibly missing) default framebuffer
+    std::unique_ptr<graphics::RenderTarget> offscreen;
+    if (isHeadless) offscreen = std::make_unique<graphics::RenderTarget>(g_ScreenWidth, g_ScreenHeight);
+    std::unique_ptr<graphics::FrameCapture> capture;
+    if (!captureFolder.empty()) capture = std::make_unique<graphics::FrameCapture>(captureFolder);
+    int frame = 0;
     // Shader programs
     graphics::Program renderProgram;
     graphics::Program skyboxRenderProgram;
     graphics::Program shadowProgram;
+    // Skeletons are drawn with instancing, one draw call per pass
+    graphics::Program instancedRenderProgram;
+    graphics::Program instancedShadowProgram;
+    // The character mesh is skinned in the vertex shader
+    graphics::Program skinnedRenderProgram;
+    graphics::Program skinnedShadowProgram;
+    // Camera and light uniforms shared by all programs
+    graphics::FrameUniforms frameUniforms;
     // Texture for shadow mapping
     graphics::ShadowMapTexture shadow(shadowTextureSize);
     // The skybox
@@ -114,6 +153,10 @@ int main() {
     graphics::Plane plane;
     // Marker
     kinematics::Ball ball;
+    // Character mesh bound to the IK skeleton, and its bone palette of the current pose
+    acclaim::Skin skin;
+    graphics::SkinnedMesh character;
+    std::vector<Eigen::AffineCompact3f> bonePalette;
     // Load assets, setup textures
     {
         // Shader
@@ -124,10 +167,26 @@ int main() {
         graphics::Shader renderFragmentShader(shader_folder / "render.frag", GL_FRAGMENT_SHADER);
         graphics::Shader skyboxVertexShader(shader_folder / "skybox.vert", GL_VERTEX_SHADER);
         graphics::Shader skyboxFragmentShader(shader_folder / "skybox.frag", GL_FRAGMENT_SHADER);
+        graphics::Shader instancedRenderVertexShader(shader_folder / "render_instanced.vert", GL_VERTEX_SHADER);
+        graphics::Shader instancedShadowVertexShader(shader_folder / "shadow_instanced.vert", GL_VERTEX_SHADER);
+        graphics::Shader skinnedRenderVertexShader(shader_folder / "render_skinned.vert", GL_VERTEX_SHADER);
+        graphics::Shader skinnedShadowVertexShader(shader_folder / "shadow_skinned.vert", GL_VERTEX_SHADER);
         // Setup shaders, these objects can be destroyed after linkShader()
         renderProgram.attachLinkShader(renderVertexShader, renderFragmentShader);
         shadowProgram.attachLinkShader(shadowVertexShader, shadowFragmentShader);
         skyboxRenderProgram.attachLinkShader(skyboxVertexShader, skyboxFragmentShader);
+        instancedRenderProgram.attachLinkShader(instancedRenderVertexShader, renderFragmentShader);
+        instancedShadowProgram.attachLinkShader(instancedShadowVertexShader, shadowFragmentShader);
+        skinnedRenderProgram.attachLinkShader(skinnedRenderVertexShader, renderFragmentShader);
+        skinnedShadowProgram.attachLinkShader(skinnedShadowVertexShader, shadowFragmentShader);
+        for (graphics::Program* program :
+             {&renderProgram, &shadowProgram, &skyboxRenderProgram, &instancedRenderProgram, &instancedShadowProgram,
+              &skinnedRenderProgram, &skinnedShadowProgram}) {
+            if (!graphics::FrameUniforms::attach(program)) return 1;
+        }
+        for (graphics::Program* program : {&skinnedRenderProgram, &skinnedShadowProgram}) {
+            if (!graphics::SkinnedMesh::attach(program)) return 1;
+        }
         // Texture
         auto texture_folder = util::PathFinder::find("Texture");
         auto wood = std::make_shared<graphics::Texture>(texture_folder / "wood.png");
@@ -140,22 +199,33 @@ int main() {
         auto acclaim_folder = util::PathFinder::find("Acclaim");
         auto skeleton = std::make_unique<acclaim::Skeleton>(acclaim_folder / "skeleton.asf", 0.2);
         IK = std::make_unique<acclaim::Motion>(acclaim_folder / "IK.amc", std::move(skeleton));
-        IK_backup = std::make_unique<acclaim::Motion>(*IK);
+        // No character mesh is shipped, so skin the skeleton with tubes around its bones
+        skin = acclaim::Skin(*IK->getSkeleton(), 0.15);
+        character.setMesh(skin.getVertices(), skin.getIndices());
+        simulation = std::make_unique<kinematics::SimulationThread>(*IK, ball.getCurrentPosition(), start_bone,
+                                                                    end_bone);
     }
     // Setup light, uniforms are persisted.
+    Eigen::Matrix4f lightSpaceMatrix = util::ortho(-30.0f, 30.0f, -30.0f, 30.0f, -75.0f, 75.0f);
     {
         Eigen::Vector4f lightPosition(11.1f, 24.9f, -14.8f, 0.0f);
-        Eigen::Matrix4f lightSpaceMatrix = util::ortho(-30.0f, 30.0f, -30.0f, 30.0f, -75.0f, 75.0f);
         lightSpaceMatrix *= util::lookAt(lightPosition, Eigen::Vector4f::Zero(), Eigen::Vector4f::UnitY());
+        frameUniforms.setLight(lightPosition, lightSpaceMatrix);
         // Shader program should be use atleast once before setting up uniforms
-        shadowProgram.use();
-        shadowProgram.setUniform("lightSpaceMatrix", lightSpaceMatrix);
-
-        renderProgram.use();
-        renderProgram.setUniform("lightSpaceMatrix", lightSpaceMatrix);
-        renderProgram.setUniform("shadowMap", shadow.getIndex());
-        renderProgram.setUniform("lightPos", lightPosition);
+        for (graphics::Program* program : {&renderProgram, &instancedRenderProgram, &skinnedRenderProgram}) {
+            program->use();
+            program->setUniform("shadowMap", shadow.getIndex());
+        }
     }
+    // Dynamic shadow casters as of the last shadow pass
+    bool isShadowValid = false;
+    unsigned int shadowRevision = 0;
+    Eigen::Vector4d shadowBallPosition = Eigen::Vector4d::Zero();
+    bool shadowUsingSkin = isUsingSkin;
+    // Inputs as last sent to the simulation, and the frame it sent back
+    Eigen::Vector4d sentTarget = ball.getCurrentPosition();
+    int sentStartBone = start_bone, sentEndBone = end_bone;
+    unsigned int poseSequence = 0;
     while (!glfwWindowShouldClose(window)) {
         // Moving camera only if debug camera is on.
         if (isUsingFreeCamera) {
@@ -163,35 +233,96 @@ int main() {
             freeCamera.moveCamera(window);
         }
         currentCamera->update();
-        isStable = IK->inverseKinematics(ball.getCurrentPosition(), start_bone, end_bone);
+        frameUniforms.setCamera(*currentCamera);
+        frameUniforms.update();
+        // A full queue keeps the sent values, so the edit is retried next frame
+        if (ball.getCurrentPosition() != sentTarget && simulation->setTarget(ball.getCurrentPosition())) {
+            sentTarget = ball.getCurrentPosition();
+        }
+        if ((start_bone != sentStartBone || end_bone != sentEndBone) && simulation->setBones(start_bone, end_bone)) {
+            sentStartBone = start_bone;
+            sentEndBone = end_bone;
+        }
+        // Headless images must not depend on how far the simulation got
+        if (isHeadless) {
+            simulation->synchronize();
+        } else {
+            simulation->update();
+        }
+        const kinematics::SimulationFrame& simulationFrame = simulation->getFrame();
+        if (simulationFrame.sequence != poseSequence) {
+            IK->setPose(simulationFrame.pose, simulationFrame.model_matrices, simulationFrame.normal_matrices);
+            isStable = simulationFrame.is_stable;
+            poseSequence = simulationFrame.sequence;
+        }
         ball.setModelMatrix();
+        // The palette is all the CPU work skinning needs, whatever the vertex count
+        if (isUsingSkin) {
+            skin.computePalette(IK->getPose(), bonePalette);
+            character.setBonePalette(bonePalette);
+        }
 
-        // 1. Render shadow to texture
-        glViewport(0, 0, shadow.getShadowSize(), shadow.getShadowSize());
-        glCullFace(GL_FRONT);
-        shadowProgram.use();
-        shadow.bindFrameBuffer();
-        glClear(GL_DEPTH_BUFFER_BIT);
-        plane.render(&shadowProgram);
-        ball.render(&shadowProgram);
-        IK->render(&shadowProgram);
-        shadow.unbindFrameBuffer();
-        glCullFace(GL_BACK);
+        // 1. Render shadow to texture, the light is fixed so it only changes when a dynamic caster moves.
+        // Moving the light or the plane must also clear isShadowValid and call shadow.invalidateStaticCache()
+        if (!isShadowValid || IK->getRenderRevision() != shadowRevision ||
+            ball.getCurrentPosition() != shadowBallPosition || isUsingSkin != shadowUsingSkin) {
+            glViewport(0, 0, shadow.getShadowSize(), shadow.getShadowSize());
+            // Casters only need the detail the shadow map can resolve
+            const int shadowSize = shadow.getShadowSize();
+            graphics::LevelOfDetail::setViewProjection(lightSpaceMatrix, shadowSize, shadowSize);
+            glCullFace(GL_FRONT);
+            shadowProgram.use();
+            // Static casters are rasterized once and copied back every time, until invalidateStaticCache()
+            if (!shadow.hasStaticCache()) {
+                shadow.beginStaticCache();
+                glClear(GL_DEPTH_BUFFER_BIT);
+                plane.render(&shadowProgram);
+                shadow.endStaticCache();
+            }
+            shadow.restoreStaticCache();
+            ball.render(&shadowProgram);
+            if (isUsingSkin) {
+                skinnedShadowProgram.use();
+                character.render(&skinnedShadowProgram);
+            } else {
+                instancedShadowProgram.use();
+                IK->render(&instancedShadowProgram);
+            }
+            shadow.unbindFrameBuffer();
+            glCullFace(GL_BACK);
+            isShadowValid = true;
+            shadowRevision = IK->getRenderRevision();
+            shadowBallPosition = ball.getCurrentPosition();
+            shadowUsingSkin = isUsingSkin;
+        }
         // 2. Render scene
+        if (offscreen) offscreen->bind();
         glViewport(0, 0, g_ScreenWidth, g_ScreenHeight);
+        graphics::LevelOfDetail::setViewProjection(currentCamera->getViewWithProjectionMatrix(), g_ScreenWidth,
+                                                   g_ScreenHeight);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         renderProgram.use();
-        renderProgram.setUniform("viewPos", currentCamera->getPosition());
-        renderProgram.setUniform("VP", currentCamera->getViewWithProjectionMatrix());
-
         plane.render(&renderProgram);
         ball.render(&renderProgram);
-        IK->render(&renderProgram);
+        if (isUsingSkin) {
+            skinnedRenderProgram.use();
+            character.render(&skinnedRenderProgram);
+        } else {
+            instancedRenderProgram.use();
+            IK->render(&instancedRenderProgram);
+        }
         // 3. Render the skybox .
         skyboxRenderProgram.use();
-        skyboxRenderProgram.setUniform("projection", currentCamera->getProjectionMatrix());
-        skyboxRenderProgram.setUniform("view", currentCamera->getViewMatrix());
         skybox.render(&skyboxRenderProgram);
+        if (capture) capture->capture(offscreen ? offscreen->getFrameBuffer() : 0, g_ScreenWidth, g_ScreenHeight);
+        if (isHeadless) {
+            offscreen->unbind();
+            if (++frame == headlessFrames) {
+                offscreen->writePPM(headlessOutput);
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
+            continue;
+        }
         // 4. Render ImGui UI
         renderUI(window, &ball);
         glFlush();
@@ -199,11 +330,43 @@ int main() {
         // Keyboard and mouse inputs.
         glfwPollEvents();
     }
+    // Readbacks still in flight need the context
+    capture.reset();
+    offscreen.reset();
     shutdown();
     glfwDestroyWindow(window);
     return 0;
 }
 
+bool parseArguments(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            isHeadless = true;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            headlessFrames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            headlessOutput = argv[++i];
+        } else if (std::strcmp(argv[i], "--capture") == 0 && hasValue) {
+            captureFolder = argv[++i];
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 2 < argc) {
+            g_ScreenWidth = std::atoi(argv[++i]);
+            g_ScreenHeight = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0]
+                      << " [--headless] [--frames <count>] [--output <file.ppm>] [--size <width> <height>]"
+                      << " [--capture <folder>]" << std::endl;
+            return false;
+        }
+    }
+    if (headlessFrames < 1 || g_ScreenWidth < 1 || g_ScreenHeight < 1) {
+        std::cerr << "Frame count and size must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void reshape(GLFWwindow*, int screenWidth, int screenHeight) {
     g_ScreenWidth = screenWidth;
     g_ScreenHeight = screenHeight;
@@ -221,8 +384,13 @@ GLFWwindow* initialize() {
     std::atexit(glfwTerminate);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (isHeadless) {
+        // With GLFW_USE_OSMESA the window is only an OSMesa context, which cannot be forward compatible
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    } else {
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    }
     // Create GLFW context
     GLFWwindow* window = glfwCreateWindow(g_ScreenWidth, g_ScreenHeight, "Inverse Kinematics", nullptr, nullptr);
     if (window == nullptr) {
@@ -230,7 +398,8 @@ GLFWwindow* initialize() {
         return nullptr;
     }
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+    // Headless frames are not presented, so there is nothing to wait for
+    glfwSwapInterval(isHeadless ? 0 : 1);
     // Initialize glad
     if (!gladLoadGL(glfwGetProcAddress)) {
         std::cerr << "Failed to initialize OpenGL context" << std::endl;
@@ -245,8 +414,9 @@ GLFWwindow* initialize() {
     // ----------------------------------------------------------
     // For high dpi monitors
     glfwGetFramebufferSize(window, &g_ScreenWidth, &g_ScreenHeight);
+    // There is no monitor without a display
     GLFWmonitor* moniter = glfwGetPrimaryMonitor();
-    const GLFWvidmode* vidMode = glfwGetVideoMode(moniter);
+    const GLFWvidmode* vidMode = moniter != nullptr ? glfwGetVideoMode(moniter) : nullptr;
     int maxTextureSize = 1024;
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
     shadowTextureSize = std::min(shadowTextureSize, maxTextureSize);
@@ -255,8 +425,10 @@ GLFWwindow* initialize() {
               << ": " << glGetString(GL_RENDERER) << std::endl;
     std::cout << std::left << std::setw(26) << "Current OpenGL context"
               << ": " << glGetString(GL_VERSION) << std::endl;
-    std::cout << std::left << std::setw(26) << "Moniter refresh rate"
-              << ": " << vidMode->refreshRate << " Hz" << std::endl;
+    if (vidMode != nullptr) {
+        std::cout << std::left << std::setw(26) << "Moniter refresh rate"
+                  << ": " << vidMode->refreshRate << " Hz" << std::endl;
+    }
     std::cout << std::left << std::setw(26) << "Max texture size support"
               << ": " << maxTextureSize << " * " << maxTextureSize << std::endl;
     std::cout << std::left << std::setw(26) << "Shadow texture size"
@@ -271,6 +443,7 @@ GLFWwindow* initialize() {
     // Setup GLFW
     reshape(window, g_ScreenWidth, g_ScreenHeight);
     glfwSetFramebufferSizeCallback(window, reshape);
+    if (isHeadless) return window;
     // Initialize dear-ImGui
     ImGui::CreateContext();
     ImGui::StyleColorsDark();
@@ -296,8 +469,9 @@ void cameraKeyboard(GLFWwindow* window, int key, int, int action, int) {
 }
 
 void shutdown() {
+    simulation.reset();
     IK.reset();
-    IK_backup.reset();
+    if (isHeadless) return;
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -305,7 +479,7 @@ void shutdown() {
 
 void mainPanel(kinematics::Ball* ball) {
     // Main Panel
-    ImGui::SetNextWindowSize(ImVec2(300.0f, 210.0f), ImGuiCond_Once);
+    ImGui::SetNextWindowSize(ImVec2(300.0f, 235.0f), ImGuiCond_Once);
     ImGui::SetNextWindowCollapsed(0, ImGuiCond_Once);
     ImGui::SetNextWindowPos(ImVec2(60.0f, 525.0f), ImGuiCond_Once);
     ImGui::SetNextWindowBgAlpha(0.2f);
@@ -316,12 +490,17 @@ void mainPanel(kinematics::Ball* ball) {
             isUsingCameraPanel ^= true;
         }
         ImGui::SameLine();
-        if (ImGui::Button("Reset Skeleton")) {
-            IK.reset();
-            IK = std::make_unique<acclaim::Motion>(*IK_backup);
+        if (ImGui::Button("Reset Skeleton") && !simulation->reset()) {
+            std::cerr << "Simulation is busy, try again" << std::endl;
+        }
+        ImGui::SameLine();
+        // The simulation owns the edited motion
+        if (ImGui::Button("Export") && !simulation->exportMotion("IK_edited")) {
+            std::cerr << "Simulation is busy, try again" << std::endl;
         }
         ImGui::SameLine();
         ImGui::Text(isStable ? "Stable" : "Unstable");
+        ImGui::Checkbox("Skinned mesh", &isUsingSkin);
         auto&& bpos = ball->getCurrentPosition();
         if (ImGui::InputDouble("target x", &bpos[0], 0.01, 0.1, "%.2lf")) {
             bpos[0] = std::clamp(bpos[0], -10.0, 10.0);
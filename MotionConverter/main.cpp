@@ -0,0 +1,170 @@
+/*
+MotionConverter: convert a whole mocap folder to binary motion caches
+
+Usage: MotionConverter <folder> <scale> [manifest file]
+
+Every .amc file under folder (recursively) is paired with its skeleton: the .asf with the same name, the .asf
+named after the subject prefix (CMU layout, 01_02.amc -> 01.asf) or the only .asf in the same folder. Clips are
+parsed on all hardware threads, checked against the skeleton's bones and DOFs by the parser, and written as
+.amcb caches next to the AMC files, where acclaim::loadMotionClip picks them up. Up to date caches are kept.
+
+The manifest (default <folder>/manifest.csv) lists every clip with its frame count, duration and skeleton
+fingerprint, so a catalog can be queried without opening any motion file.
+*/
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "acclaim/amc_parser.h"
+#include "acclaim/motion_cache.h"
+#include "acclaim/motion_clip.h"
+#include "acclaim/skeleton.h"
+#include "util/filesystem.h"
+#include "util/text_writer.h"
+
+namespace {
+enum class Status { Failed, Converted, UpToDate };
+
+struct Job {
+    util::fs::path amc_file;
+    util::fs::path asf_file;
+    const acclaim::Skeleton *skeleton = nullptr;
+    Status status = Status::Failed;
+    int frame_num = 0;
+    int channel_num = 0;
+    double frame_rate = 0.0;
+};
+
+// Find the skeleton of an AMC file, empty if there is none
+util::fs::path findSkeleton(const util::fs::path &amc_file) {
+    std::error_code error;
+    util::fs::path asf_file = amc_file;
+    asf_file.replace_extension(".asf");
+    if (util::fs::exists(asf_file, error)) return asf_file;
+    const std::string stem = amc_file.stem().string();
+    const std::size_t subject_end = stem.find('_');
+    if (subject_end != std::string::npos) {
+        asf_file = amc_file.parent_path() / (stem.substr(0, subject_end) + ".asf");
+        if (util::fs::exists(asf_file, error)) return asf_file;
+    }
+    asf_file.clear();
+    for (const auto &entry : util::fs::directory_iterator(amc_file.parent_path(), error)) {
+        if (entry.path().extension() != ".asf") continue;
+        // More than one candidate is ambiguous
+        if (!asf_file.empty()) return util::fs::path();
+        asf_file = entry.path();
+    }
+    return asf_file;
+}
+
+void convert(Job &job) {
+    acclaim::MotionClip clip{acclaim::ChannelLayout(*job.skeleton)};
+    const util::fs::path cache_file = acclaim::motionCachePath(job.amc_file);
+    if (acclaim::readMotionCache(cache_file, *job.skeleton, clip, job.amc_file)) {
+        job.status = Status::UpToDate;
+    } else if (acclaim::readAMCFile(job.amc_file, *job.skeleton, clip, 1) &&
+               acclaim::writeMotionCache(cache_file, clip, *job.skeleton, job.amc_file)) {
+        job.status = Status::Converted;
+    } else {
+        return;
+    }
+    job.frame_num = clip.getFrameNum();
+    job.channel_num = clip.getChannelNum();
+    job.frame_rate = clip.getFrameRate();
+}
+
+bool writeManifest(const util::fs::path &manifest_file, const util::fs::path &folder, const std::vector<Job> &jobs) {
+    constexpr const char *status_names[] = {"failed", "converted", "up to date"};
+    util::TextWriter writer;
+    if (!writer.open(manifest_file)) return false;
+    writer.write("amc,asf,status,frames,frame_rate,duration,channels,fingerprint\n");
+    for (const Job &job : jobs) {
+        writer.write(job.amc_file.lexically_relative(folder).generic_string()).put(',');
+        writer.write(job.asf_file.lexically_relative(folder).generic_string()).put(',');
+        writer.write(status_names[static_cast<int>(job.status)]).put(',');
+        writer.write(job.frame_num).put(',').write(job.frame_rate).put(',');
+        writer.write(job.frame_rate > 0.0 ? job.frame_num / job.frame_rate : 0.0).put(',');
+        writer.write(job.channel_num).put(',');
+        char fingerprint[16];
+        const std::uint64_t value = job.skeleton == nullptr ? 0 : job.skeleton->getFingerprint();
+        const auto result = std::to_chars(fingerprint, fingerprint + sizeof(fingerprint), value, 16);
+        writer.write(std::string_view(fingerprint, result.ptr - fingerprint)).put('\n');
+    }
+    if (!writer.close()) {
+        std::cerr << "Failed to write " << manifest_file << std::endl;
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <folder> <scale> [manifest file]" << std::endl;
+        return 1;
+    }
+    const util::fs::path folder(argv[1]);
+    const double scale = std::strtod(argv[2], nullptr);
+    const util::fs::path manifest_file = argc == 4 ? util::fs::path(argv[3]) : folder / "manifest.csv";
+
+    std::vector<Job> jobs;
+    std::error_code error;
+    for (auto it = util::fs::recursive_directory_iterator(folder, error);
+         !error && it != util::fs::recursive_directory_iterator(); it.increment(error)) {
+        if (it->path().extension() == ".amc") jobs.emplace_back().amc_file = it->path();
+    }
+    if (error) {
+        std::cerr << "Failed to list " << folder << ": " << error.message() << std::endl;
+        return 1;
+    }
+    // Directory order is unspecified, sort so the manifest is stable
+    std::sort(jobs.begin(), jobs.end(), [](const Job &a, const Job &b) { return a.amc_file < b.amc_file; });
+
+    // Every skeleton is read once up front, clips of one subject share it
+    std::map<util::fs::path, std::unique_ptr<acclaim::Skeleton>> skeletons;
+    for (Job &job : jobs) {
+        job.asf_file = findSkeleton(job.amc_file);
+        if (job.asf_file.empty()) {
+            std::cerr << "No skeleton found for " << job.amc_file << std::endl;
+            continue;
+        }
+        auto &skeleton = skeletons[job.asf_file];
+        if (!skeleton) skeleton = std::make_unique<acclaim::Skeleton>(job.asf_file, scale);
+        // A skeleton that failed to parse stays cached so it is read once, but none of its clips are converted
+        if (!skeleton->isLoaded()) {
+            std::cerr << "Bad skeleton " << job.asf_file << " for " << job.amc_file << std::endl;
+            continue;
+        }
+        job.skeleton = skeleton.get();
+    }
+
+    // Clips are converted one per thread, each parsed on its own thread
+    std::atomic<std::size_t> next_job{0};
+    auto work = [&] {
+        for (std::size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            if (jobs[i].skeleton != nullptr) convert(jobs[i]);
+        }
+    };
+    const unsigned thread_num = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < thread_num; ++i) workers.emplace_back(work);
+    work();
+    for (std::thread &worker : workers) worker.join();
+
+    int counts[3] = {0, 0, 0};
+    for (const Job &job : jobs) ++counts[static_cast<int>(job.status)];
+    std::cout << jobs.size() << " clips: " << counts[static_cast<int>(Status::Converted)] << " converted, "
+              << counts[static_cast<int>(Status::UpToDate)] << " up to date, "
+              << counts[static_cast<int>(Status::Failed)] << " failed" << std::endl;
+    if (!writeManifest(manifest_file, folder, jobs)) return 1;
+    return counts[static_cast<int>(Status::Failed)] == 0 ? 0 : 1;
+}
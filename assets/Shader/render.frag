@@ -6,12 +6,20 @@ in VS_OUT {
     vec3 Normal;
     vec2 TexCoords;
     vec4 FragPosLightSpace;
+    vec4 Color;
 } fs_in;
 
+// Per-frame camera and light, see graphics::FrameUniforms
+layout(std140) uniform FrameUniforms {
+    mat4 VP;
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+};
+
 uniform int useTexture;
-uniform vec4 baseColor;
-uniform vec4 lightPos;
-uniform vec4 viewPos;
 uniform sampler2D diffuseTexture;
 uniform sampler2DShadow shadowMap;
 
@@ -30,7 +38,7 @@ float calculateShadow(vec3 projectionCoordinate, float normaldotlight) {
     return 0.25 + shadow / 12.0;
 }
 void main() {
-    vec3 color = useTexture == 1 ? texture(diffuseTexture, fs_in.TexCoords).rgb : baseColor.rgb;
+    vec3 color = useTexture == 1 ? texture(diffuseTexture, fs_in.TexCoords).rgb : fs_in.Color.rgb;
     vec3 normal = normalize(fs_in.Normal);
     vec3 lightColor = vec3(0.65);
     // Ambient
@@ -8,17 +8,28 @@ out VS_OUT {
     vec3 Normal;
     vec2 TexCoords;
     vec4 FragPosLightSpace;
+    vec4 Color;
 } vs_out;
 
+// Per-frame camera and light, see graphics::FrameUniforms
+layout(std140) uniform FrameUniforms {
+    mat4 VP;
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+};
+
 uniform mat4 model;
-uniform mat4 VP;
-uniform mat4 lightSpaceMatrix;
 uniform mat4 invtransmodel;
+uniform vec4 baseColor;
 
 void main() {
     vs_out.FragPos = vec3(model * vec4(position, 1.0));
     vs_out.Normal = mat3(invtransmodel) * normal_in;
     vs_out.TexCoords = TexCoord_in;
     vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
+    vs_out.Color = baseColor;
     gl_Position = VP * model * vec4(position, 1.0);
 }
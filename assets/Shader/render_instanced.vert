@@ -0,0 +1,35 @@
+#version 410 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal_in;
+layout(location = 2) in vec2 TexCoord_in;
+// Per-instance attributes, see graphics::InstancedCylinder
+layout(location = 3) in mat4x3 model;
+layout(location = 7) in mat3 invtransmodel;
+layout(location = 10) in vec4 color;
+
+out VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+    vec4 FragPosLightSpace;
+    vec4 Color;
+} vs_out;
+
+// Per-frame camera and light, see graphics::FrameUniforms
+layout(std140) uniform FrameUniforms {
+    mat4 VP;
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+};
+
+void main() {
+    vs_out.FragPos = model * vec4(position, 1.0);
+    vs_out.Normal = invtransmodel * normal_in;
+    vs_out.TexCoords = TexCoord_in;
+    vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
+    vs_out.Color = color;
+    gl_Position = VP * vec4(vs_out.FragPos, 1.0);
+}
@@ -0,0 +1,43 @@
+#version 410 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal_in;
+layout(location = 2) in vec2 TexCoord_in;
+// Skinning influences, see graphics::SkinnedVertex
+layout(location = 3) in uvec4 boneIndices;
+layout(location = 4) in vec4 boneWeights;
+
+out VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+    vec4 FragPosLightSpace;
+    vec4 Color;
+} vs_out;
+
+// Per-frame camera and light, see graphics::FrameUniforms
+layout(std140) uniform FrameUniforms {
+    mat4 VP;
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+};
+// Rigid skin matrix of each bone, size is graphics::g_MaxSkinBones
+layout(std140) uniform BonePalette {
+    mat4 bones[64];
+};
+
+uniform vec4 baseColor;
+
+void main() {
+    // Linear blend skinning, blended rigid matrices still transform normals well enough without an inverse
+    mat4 skin = boneWeights.x * bones[boneIndices.x] + boneWeights.y * bones[boneIndices.y] +
+                boneWeights.z * bones[boneIndices.z] + boneWeights.w * bones[boneIndices.w];
+    vs_out.FragPos = vec3(skin * vec4(position, 1.0));
+    vs_out.Normal = mat3(skin) * normal_in;
+    vs_out.TexCoords = TexCoord_in;
+    vs_out.FragPosLightSpace = lightSpaceMatrix * vec4(vs_out.FragPos, 1.0);
+    vs_out.Color = baseColor;
+    gl_Position = VP * vec4(vs_out.FragPos, 1.0);
+}
@@ -1,7 +1,16 @@
 #version 410 core
 layout(location = 0) in vec3 position;
 
-uniform mat4 lightSpaceMatrix;
+// Per-frame camera and light, see graphics::FrameUniforms
+layout(std140) uniform FrameUniforms {
+    mat4 VP;
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+};
+
 uniform mat4 model;
 
 void main() {
@@ -0,0 +1,18 @@
+#version 410 core
+layout(location = 0) in vec3 position;
+// Per-instance attributes, see graphics::InstancedCylinder
+layout(location = 3) in mat4x3 model;
+
+// Per-frame camera and light, see graphics::FrameUniforms
+layout(std140) uniform FrameUniforms {
+    mat4 VP;
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+};
+
+void main() {
+    gl_Position = lightSpaceMatrix * vec4(model * vec4(position, 1.0f), 1.0f);
+}
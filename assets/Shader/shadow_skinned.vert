@@ -0,0 +1,25 @@
+#version 410 core
+layout(location = 0) in vec3 position;
+// Skinning influences, see graphics::SkinnedVertex
+layout(location = 3) in uvec4 boneIndices;
+layout(location = 4) in vec4 boneWeights;
+
+// Per-frame camera and light, see graphics::FrameUniforms
+layout(std140) uniform FrameUniforms {
+    mat4 VP;
+    mat4 view;
+    mat4 projection;
+    mat4 lightSpaceMatrix;
+    vec4 viewPos;
+    vec4 lightPos;
+};
+// Rigid skin matrix of each bone, size is graphics::g_MaxSkinBones
+layout(std140) uniform BonePalette {
+    mat4 bones[64];
+};
+
+void main() {
+    mat4 skin = boneWeights.x * bones[boneIndices.x] + boneWeights.y * bones[boneIndices.y] +
+                boneWeights.z * bones[boneIndices.z] + boneWeights.w * bones[boneIndices.w];
+    gl_Position = lightSpaceMatrix * skin * vec4(position, 1.0f);
+}
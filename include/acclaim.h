@@ -1,3 +1,4 @@
 #pragma once
 #include "acclaim/motion.h"
 #include "acclaim/skeleton.h"
+#include "acclaim/skin.h"
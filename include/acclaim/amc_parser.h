@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "bone.h"
+#include "channel_layout.h"
+#include "motion_clip.h"
+#include "skeleton.h"
+#include "util/filesystem.h"
+#include "util/tokenizer.h"
+
+namespace acclaim {
+// Start of a frame in AMC text
+struct AMCFrameOffset {
+    const char *position;
+    int line;
+};
+// Record every stride-th frame of AMC text into offsets and return the number of frames.
+// Bone lines start with a name and header lines with '#' or ':', so frames are the lines starting with a digit
+int indexAMCFrames(const char *begin, const char *end, int stride, std::vector<AMCFrameOffset> &offsets);
+// Parse every frame of an AMC file into clip (which must use ChannelLayout(skeleton)), in parallel by chunks.
+// thread_num 0 uses every hardware thread
+bool readAMCFile(const util::fs::path &file_name, const Skeleton &skeleton, MotionClip &clip, int thread_num = 0);
+
+// Parse AMC text in memory frame by frame into MotionClip rows
+class AMCParser final {
+ public:
+    // name is only used in error messages, first_line is the line number of begin
+    AMCParser(const Skeleton &skeleton, const ChannelLayout &layout, const char *begin, const char *end,
+              const std::string &name, int first_line = 1) noexcept;
+    // Skip the header (comment lines starting with '#' and keyword lines starting with ':')
+    void readHeader();
+    // true if there are no more frames
+    bool eof();
+    // Parse the next frame into row (layout.getChannelNum() values), false on malformed input
+    bool readFrame(double *row);
+    // get frame number written in the last frame
+    int getFrameNumber() const;
+    // get bone of each line in the last frame, i.e. the order the file lists bones in
+    const std::vector<const Bone *> &getLineBones() const;
+    // get current read position
+    const char *position() const;
+
+ private:
+    const Skeleton *skeleton;
+    const ChannelLayout *layout;
+    util::Tokenizer tokenizer;
+    // Bone of each line in the previous frame, AMC files list bones in the same order every frame
+    std::vector<const Bone *> line_bones;
+    // Columns of the root translation, scaled like the skeleton
+    int root_translations[3];
+    int frame_number = 0;
+};
+}  // namespace acclaim
@@ -1,15 +1,20 @@
 #pragma once
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "Eigen/Core"
 #include "Eigen/Geometry"
 #include "Eigen/StdVector"
 
+#include "util/helper.h"
+
 namespace acclaim {
 // Bone segment names used in ASF file
 // this structure defines the property of each bone segment, including its
 // connection to other bones, DOF (degrees of freedom), relative orientation and
 // distance to the outboard bone
+// Bones are immutable once the skeleton is loaded
 struct Bone final {
     // You need this for alignment otherwise it may crash
     // Ref: https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
@@ -31,6 +36,10 @@ struct Bone final {
     std::string name = "";
     // Bone length
     double length = 0.0;
+    // Direction and length exactly as written in the ASF file (global coordinate, unscaled),
+    // kept so that Skeleton::writeASFFile reproduces the file
+    Eigen::Vector4d asf_dir = Eigen::Vector4d::Zero();
+    double asf_length = 0.0;
     // Orientation of each bone's local coordinate
     // system as specified in ASF file (axis field)
     Eigen::Vector4d axis = Eigen::Vector4d::Zero();
@@ -39,16 +48,15 @@ struct Bone final {
     // degree of freedom mask in x, y, z axis (local)
     bool dofrx = false, dofry = false, dofrz = false;  // Rotate
     bool doftx = false, dofty = false, doftz = false;  // Translate
-    // Rotation matrix from parent to child
-    Eigen::Affine3d rot_parent_current = Eigen::Affine3d::Identity();
+    // DOFs in the order of the ASF dof line (e.g. "rz rx") and their (min, max) limits, empty without a limits
+    // line. Only kept so that Skeleton::writeASFFile reproduces the file
+    std::string asf_dof = "";
+    std::vector<std::pair<double, double>> limits;
+    // Rotation from parent to child
+    Eigen::Quaterniond rot_parent_current = Eigen::Quaterniond::Identity();
     // Initial rotation and scaling for bone
     Eigen::Affine3d global_facing = Eigen::Affine3d::Identity();
-    // Bone's start pos in global position
-    Eigen::Vector4d start_position = Eigen::Vector4d::Zero();
-    // Bone's end pos in global position
-    Eigen::Vector4d end_position = Eigen::Vector4d::Zero();
-    // Bone's rotation in global position
-    Eigen::Affine3d rotation = Eigen::Affine3d::Identity();
+    // Note: global positions and rotations are per-evaluation state, see acclaim::Pose
 };
 }  // namespace acclaim
 EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(acclaim::Bone)
@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "posture.h"
+
+namespace acclaim {
+class Skeleton;
+// One AMC channel, listed in the order they appear on a bone's AMC line
+enum class ChannelType : std::uint8_t { TX = 0, TY, TZ, RX, RY, RZ };
+
+// Columns of one frame in a flat motion row, derived from the skeleton's DOFs.
+// Bones are laid out by bone index and each bone's channels are contiguous in ChannelType order,
+// bones and channels without DOF take no space.
+class ChannelLayout final {
+ public:
+    ChannelLayout() noexcept;
+    explicit ChannelLayout(const Skeleton &skeleton) noexcept;
+    ChannelLayout(const ChannelLayout &) noexcept;
+    ChannelLayout(ChannelLayout &&) noexcept;
+
+    ChannelLayout &operator=(const ChannelLayout &) noexcept;
+    ChannelLayout &operator=(ChannelLayout &&) noexcept;
+    bool operator==(const ChannelLayout &other) const;
+    bool operator!=(const ChannelLayout &other) const;
+    // get total channels in one frame
+    int getChannelNum() const;
+    // get total bones of the skeleton this layout is derived from
+    int getBoneNum() const;
+    // get first column of the bone's channels
+    int getBoneOffset(const int bone_idx) const;
+    // get number of channels of the bone
+    int getBoneChannelNum(const int bone_idx) const;
+    // get column of the bone's channel, -1 if the bone has no such DOF
+    int getChannelIndex(const int bone_idx, const ChannelType type) const;
+    // get the bone a column belongs to
+    int getChannelBone(const int channel) const;
+    // get the kind of a column
+    ChannelType getChannelType(const int channel) const;
+    // Expand one flat row into per-bone vectors, channels without DOF become zero
+    void unpack(const double *row, Posture &posture) const;
+    // Gather the DOF channels of posture into one flat row
+    void pack(const Posture &posture, double *row) const;
+
+ private:
+    // columns of (tx, ty, tz, rx, ry, rz) for each bone, -1 if not a DOF
+    std::vector<std::array<int, 6>> channel_indices;
+    // first column of each bone, one extra entry holds the total channel number
+    std::vector<int> bone_offsets = std::vector<int>(1, 0);
+    // owner bone and kind of each column
+    std::vector<int> channel_bones;
+    std::vector<ChannelType> channel_types;
+};
+}  // namespace acclaim
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "channel_layout.h"
+#include "motion_clip.h"
+#include "posture.h"
+#include "skeleton.h"
+
+namespace acclaim {
+// Lossy, compact form of a MotionClip for keeping many clips in memory.
+// Each channel is quantized to 16 bits against its own [min, max] range and reduced to the keyframes
+// needed to stay within a per-channel tolerance under linear interpolation. The per-channel tolerances are
+// derived from the skeleton, so that no bone end moves further than the requested world-space tolerance.
+// Keys are exact up to half a quantization step, so a channel whose 16-bit half step exceeds its tolerance
+// (usually a root translation with a long range) is quantized to 32 bits instead.
+class CompressedClip final {
+ public:
+    CompressedClip() noexcept;
+    // tolerance is in world units (after the skeleton's scale), clip must use ChannelLayout(skeleton)
+    CompressedClip(const MotionClip &clip, const Skeleton &skeleton, double tolerance) noexcept;
+    CompressedClip(const CompressedClip &) noexcept;
+    CompressedClip(CompressedClip &&) noexcept;
+
+    CompressedClip &operator=(const CompressedClip &) noexcept;
+    CompressedClip &operator=(CompressedClip &&) noexcept;
+    // get the layout of decoded rows
+    const ChannelLayout &getLayout() const;
+    // get total frames
+    int getFrameNum() const;
+    // get channels per frame
+    int getChannelNum() const;
+    // get frames per second
+    double getFrameRate() const;
+    // get keyframes over all channels
+    int getKeyNum() const;
+    // true if channel's keys are quantized to 32 bits instead of 16
+    bool isWideChannel(const int channel) const;
+    // get bytes used by the compressed data
+    std::size_t getMemorySize() const;
+    // Reconstruct one frame into row (getChannelNum() values)
+    void decode(const int frame_idx, double *row) const;
+    // Reconstruct one frame in the per-bone form used by kinematics, row is scratch space of getChannelNum()
+    void decode(const int frame_idx, double *row, Posture &posture) const;
+    // Reconstruct every frame
+    MotionClip decompress() const;
+
+ private:
+    // get quantized value of channel's k-th key
+    double getKeyValue(const int channel, const std::size_t k) const;
+
+    ChannelLayout layout;
+    int frame_num = 0;
+    double frame_rate = 120.0;
+    // value = minimums[c] + steps[c] * quantized value
+    std::vector<double> minimums;
+    std::vector<double> steps;
+    // Keys of channel c are [key_offsets[c], key_offsets[c + 1]), sorted by frame.
+    // The first and last frame of a channel are always keys.
+    std::vector<std::uint32_t> key_offsets;
+    std::vector<std::uint32_t> key_frames;
+    // Values of channel c's keys start at value_offsets[c] in wide_key_values if wide_channels[c] is set,
+    // else in key_values
+    std::vector<std::uint32_t> value_offsets;
+    std::vector<std::uint8_t> wide_channels;
+    std::vector<std::uint16_t> key_values;
+    std::vector<std::uint32_t> wide_key_values;
+};
+}  // namespace acclaim
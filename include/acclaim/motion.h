@@ -4,7 +4,11 @@
 #include <vector>
 
 #include "Eigen/Core"
+#include "Eigen/Geometry"
 
+#include "graphics/instanced_cylinder.h"
+#include "motion_clip.h"
+#include "pose.h"
 #include "posture.h"
 #include "skeleton.h"
 #include "util/filesystem.h"
@@ -12,12 +16,18 @@
 namespace graphics {
 class Program;
 }
+namespace kinematics {
+struct GeneratedSolver;
+}
 
 namespace acclaim {
 
 class Motion final {
  public:
-    Motion(const util::fs::path &amc_file, std::unique_ptr<Skeleton> &&skeleton) noexcept;
+    // Skeletons are immutable, so motions of one actor can share a single instance
+    Motion(const util::fs::path &amc_file, std::shared_ptr<const Skeleton> skeleton) noexcept;
+    // Play clip (for example from a MotionLibrary), which must use ChannelLayout(*skeleton)
+    Motion(const MotionClip &clip, std::shared_ptr<const Skeleton> skeleton) noexcept;
     Motion(const Motion &) noexcept;
     Motion(Motion &&) noexcept;
 
@@ -27,20 +37,54 @@ class Motion final {
     // Ref: https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     // get the underlying skeleton
-    const std::unique_ptr<Skeleton> &getSkeleton() const;
+    const std::shared_ptr<const Skeleton> &getSkeleton() const;
     // get total frame of the motion
     int getFrameNum() const;
+    // get the motion data of every frame
+    const MotionClip &getClip() const;
+    // Write every frame as an AMC file for getSkeleton()->writeASFFile, including IK edits.
+    // Bones are listed in the order of the file the clip was read from, see MotionClip::getBoneOrder
+    bool writeAMCFile(const util::fs::path &file_name) const;
+    // Global bone transforms of the last forward or inverse kinematics, e.g. for Skin::computePalette
+    const Pose &getPose() const;
+    // Packed float bone matrices of the same pose, see kinematics::boneMatrices
+    const std::vector<Eigen::AffineCompact3f> &getModelMatrices() const;
+    const std::vector<Eigen::Matrix3f> &getNormalMatrices() const;
+    // Show a pose solved by another copy of this motion, e.g. on kinematics::SimulationThread. The clip is unchanged
+    void setPose(const Pose &pose, const std::vector<Eigen::AffineCompact3f> &model_matrices,
+                 const std::vector<Eigen::Matrix3f> &normal_matrices);
     // Forward kinematics
     void forwardkinematics(int frame_idx);
     // Inverse kinematics
     bool inverseKinematics(const Eigen::Vector4d &target, int start, int end);
-    // render the underlying skeleton
+    // set bone's color (for rendering)
+    void setBoneColor(const Eigen::Vector4f &boneColor) const;
+    // Changes whenever the rendered bones move or change color
+    unsigned int getRenderRevision() const;
+    // render the underlying skeleton with one instanced draw, Program must use an *_instanced.vert shader
     void render(graphics::Program *Program) const;
 
  private:
     // read motion data from file
     bool readAMCFile(const util::fs::path &file_name);
-    std::unique_ptr<Skeleton> skeleton;
-    std::vector<Posture> postures;
+    // Set up kinematics buffers and graphics once the clip is loaded
+    void initialize();
+    // set bone's model matrices (for rendering)
+    void setModelMatrices() const;
+    // setup graphics
+    void setBoneGraphics();
+    std::shared_ptr<const Skeleton> skeleton;
+    MotionClip clip;
+    // Per-bone expansion of the frame being evaluated, reused every frame
+    Posture posture;
+    // Global bone transforms of the current pose, written by forward kinematics
+    Pose pose;
+    // Packed float model and normal matrices of the current pose, written by forward kinematics
+    std::vector<Eigen::AffineCompact3f> model_matrices;
+    std::vector<Eigen::Matrix3f> normal_matrices;
+    // One cylinder instance per bone
+    mutable graphics::InstancedCylinder bone_graphics;
+    // FK/IK kernels generated for this skeleton, nullptr if there is none
+    const kinematics::GeneratedSolver *generated_solver = nullptr;
 };
 }  // namespace acclaim
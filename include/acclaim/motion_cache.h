@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+
+#include "motion_clip.h"
+#include "skeleton.h"
+#include "util/filesystem.h"
+
+namespace acclaim {
+// Binary motion cache (.amcb), a MotionClip that can be memory-mapped and used without parsing or copying.
+//
+// Layout (host byte order, a cache written on a machine of the other endianness is rejected and rebuilt):
+//   MotionCacheHeader                      64 bytes
+//   channel table                          channel_num * {uint16 bone index, uint8 ChannelType, uint8 0}
+//   bone order table                       movable bone num * uint16 bone index in source line order,
+//                                          all 0xFFFF if the clip has no source order
+//   padding                                up to data_offset (multiple of 64)
+//   channel data                           frame_num * channel_num doubles, row major
+//
+// A cache is only used when its version, byte order, skeleton fingerprint, channel layout and source stamp all
+// match.
+struct MotionCacheHeader final {
+    static constexpr char magic_value[8] = {'A', 'M', 'C', 'B', 'I', 'N', '\0', '\0'};
+    static constexpr std::uint16_t current_version = 3;
+    // Written in host order, reads back as 0x0201 on a machine of the other endianness
+    static constexpr std::uint16_t byte_order_value = 0x0102;
+
+    char magic[8];
+    std::uint16_t version;
+    std::uint16_t byte_order;
+    std::uint32_t channel_num;
+    std::uint64_t skeleton_fingerprint;
+    std::uint64_t frame_num;
+    double frame_rate;
+    // Offset of the channel data from the beginning of the file
+    std::uint64_t data_offset;
+    // Size and modification time of the AMC file the cache was made from, 0 if unknown
+    std::uint64_t source_size;
+    std::int64_t source_time;
+};
+static_assert(sizeof(MotionCacheHeader) == 64, "MotionCacheHeader must stay 64 bytes");
+
+// get path of the cache written next to an AMC file, e.g. walk.amc -> walk.amcb
+util::fs::path motionCachePath(const util::fs::path &amc_file);
+// Write clip as a binary cache, source is the AMC file it was parsed from (may be empty)
+bool writeMotionCache(const util::fs::path &cache_file, const MotionClip &clip, const Skeleton &skeleton,
+                      const util::fs::path &source = util::fs::path());
+// Map a binary cache into clip without copying, fails if it does not match the skeleton or is older than source
+bool readMotionCache(const util::fs::path &cache_file, const Skeleton &skeleton, MotionClip &clip,
+                     const util::fs::path &source = util::fs::path());
+// Load an AMC file through its cache, the AMC text is parsed (and the cache written) only if there is no
+// valid cache
+bool loadMotionClip(const util::fs::path &amc_file, const Skeleton &skeleton, MotionClip &clip);
+}  // namespace acclaim
@@ -0,0 +1,93 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
+
+#include "channel_layout.h"
+#include "posture.h"
+#include "util/mapped_file.h"
+
+namespace acclaim {
+// Read-only view of one frame inside a MotionClip, nothing is copied until toPosture()
+class PostureView final {
+ public:
+    PostureView(const ChannelLayout *layout, const double *row) noexcept;
+    // get bone's rotation (x, y, z, 0) in degrees, channels without DOF are zero
+    Eigen::Vector4d getRotation(const int bone_idx) const;
+    // get bone's translation (x, y, z, 0), channels without DOF are zero
+    Eigen::Vector4d getTranslation(const int bone_idx) const;
+    // get one column of the frame
+    double getChannel(const int channel) const;
+    // get the raw row, ChannelLayout::getChannelNum() values
+    const double *data() const;
+    // Expand to the per-bone form used by kinematics, reusing posture's storage
+    void toPosture(Posture &posture) const;
+
+ private:
+    const ChannelLayout *layout;
+    const double *row;
+};
+
+// All frames of a motion as one frames x channels row-major matrix, columns described by a ChannelLayout.
+// A clip is one allocation, and only DOF channels are stored.
+// The matrix can also live in a memory-mapped file (see motion_cache.h), it is copied on the first write.
+class MotionClip final {
+ public:
+    MotionClip() noexcept;
+    explicit MotionClip(const ChannelLayout &layout) noexcept;
+    MotionClip(const MotionClip &) noexcept;
+    MotionClip(MotionClip &&) noexcept;
+
+    MotionClip &operator=(const MotionClip &) noexcept;
+    MotionClip &operator=(MotionClip &&) noexcept;
+    // get the layout of every row
+    const ChannelLayout &getLayout() const;
+    // get total frames
+    int getFrameNum() const;
+    // get channels per frame
+    int getChannelNum() const;
+    // get frames per second
+    double getFrameRate() const;
+    // set frames per second
+    void setFrameRate(const double frame_rate);
+    // true if frames are read from a mapped file instead of owned memory
+    bool isMapped() const;
+    // get bone indices in the order the source AMC file lists them every frame, empty if not read from a file
+    const std::vector<int> &getBoneOrder() const;
+    // set the source file's bone order, so the clip can be written back the same way
+    void setBoneOrder(std::vector<int> bone_order);
+    // get a view of one frame
+    PostureView getPosture(const int frame_idx) const;
+    // get one frame's row
+    double *getFrameData(const int frame_idx);
+    const double *getFrameData(const int frame_idx) const;
+    // Overwrite a frame with posture's DOF channels
+    void setPosture(const int frame_idx, const Posture &posture);
+    // Append a zeroed frame and return its row, the pointer is valid until the next append
+    double *appendFrame();
+    // Reserve rows for frame_num frames
+    void reserve(const int frame_num);
+    // Resize to frame_num frames, new frames are zeroed
+    void resize(const int frame_num);
+    // Drop over-allocated rows once loading is done
+    void shrinkToFit();
+    // Use frame_num rows stored in file starting at data without copying, data must stay inside file
+    void attach(const std::shared_ptr<const util::MappedFile> &file, const double *data, const int frame_num);
+
+ private:
+    // Copy mapped frames into owned memory before they are modified
+    void detach();
+
+    ChannelLayout layout;
+    std::vector<double> channels;
+    // AMC files do not store the rate, CMU captures are sampled at 120 Hz
+    double frame_rate = 120.0;
+    // Bone line order of the AMC file, which differs from index order, e.g. CMU lists root, lowerback, ...
+    std::vector<int> bone_order;
+    // Mapped frames, used instead of channels while mapping is set
+    std::shared_ptr<const util::MappedFile> mapping;
+    const double *mapped_channels = nullptr;
+    int mapped_frame_num = 0;
+};
+}  // namespace acclaim
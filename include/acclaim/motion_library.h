@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "motion_clip.h"
+#include "skeleton.h"
+#include "util/filesystem.h"
+
+namespace acclaim {
+// Many AMC clips of one actor, all read against one shared skeleton.
+// Clips are loaded on first use (through the binary cache, see motion_cache.h) and kept resident while they
+// fit in the memory budget. The least recently used clips are dropped beyond it and reloaded when needed again.
+class MotionLibrary final {
+ public:
+    // memory_budget is in bytes of frame data
+    MotionLibrary(std::shared_ptr<const Skeleton> skeleton, std::size_t memory_budget) noexcept;
+    MotionLibrary(const MotionLibrary &) noexcept;
+    MotionLibrary(MotionLibrary &&) noexcept;
+
+    MotionLibrary &operator=(const MotionLibrary &) noexcept;
+    MotionLibrary &operator=(MotionLibrary &&) noexcept;
+    // get the skeleton shared by every clip
+    const std::shared_ptr<const Skeleton> &getSkeleton() const;
+    // Register an AMC file and return its clip index, nothing is read until the clip is used
+    int addClip(const util::fs::path &amc_file);
+    // Register every .amc file in folder (not recursive), returns the number of clips added
+    int addFolder(const util::fs::path &folder);
+    // get total registered clips
+    int getClipNum() const;
+    // get the AMC file of a clip
+    const util::fs::path &getClipPath(const int clip_idx) const;
+    // get a clip, loading it if it is not resident. nullptr if it cannot be read.
+    // The returned clip stays valid even if the library evicts it.
+    std::shared_ptr<const MotionClip> getClip(const int clip_idx);
+    // true if the clip is in memory
+    bool isResident(const int clip_idx) const;
+    // get bytes of frame data currently resident
+    std::size_t getResidentSize() const;
+    // get memory budget in bytes
+    std::size_t getMemoryBudget() const;
+    // set memory budget in bytes, evicting clips if needed
+    void setMemoryBudget(const std::size_t memory_budget);
+
+ private:
+    struct Entry {
+        util::fs::path file_name;
+        std::shared_ptr<const MotionClip> clip;
+        std::size_t size = 0;
+        // Position in lru while resident
+        std::list<int>::iterator lru_position;
+    };
+    // Drop least recently used clips until resident clips fit the budget, keep_idx is never dropped
+    void evict(const int keep_idx);
+
+    std::shared_ptr<const Skeleton> skeleton;
+    std::size_t memory_budget;
+    std::size_t resident_size = 0;
+    std::vector<Entry> entries;
+    // Resident clip indices, most recently used first
+    std::list<int> lru;
+};
+}  // namespace acclaim
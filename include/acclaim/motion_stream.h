@@ -0,0 +1,76 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "amc_parser.h"
+#include "channel_layout.h"
+#include "posture.h"
+#include "skeleton.h"
+#include "util/filesystem.h"
+#include "util/mapped_file.h"
+
+namespace acclaim {
+// Frames of an AMC file decoded on demand, for captures too long to keep in a MotionClip.
+// The file is memory-mapped and a background thread decodes ahead of the last requested frame
+// into a ring of window frames. Seeks restart decoding from a sparse index of frame offsets.
+class MotionStream final {
+ public:
+    // Frames between two index entries, a seek decodes at most this many frames before the target
+    static constexpr int index_stride = 64;
+    // skeleton must outlive the stream, window is the number of decoded frames kept in memory
+    explicit MotionStream(const Skeleton &skeleton, int window = 256) noexcept;
+    // The read-ahead thread points into this object
+    MotionStream(const MotionStream &) = delete;
+    MotionStream(MotionStream &&) = delete;
+    ~MotionStream();
+
+    MotionStream &operator=(const MotionStream &) = delete;
+    MotionStream &operator=(MotionStream &&) = delete;
+    // Index amc_file and start reading ahead from the first frame, any previous file is closed first
+    bool open(const util::fs::path &amc_file);
+    void close();
+    bool isOpen() const;
+    // get channel layout of decoded frames
+    const ChannelLayout &getLayout() const;
+    // get total frame of the motion
+    int getFrameNum() const;
+    // Copy a frame (layout.getChannelNum() values) into row, waits until it is decoded.
+    // false if frame_idx is out of range or the file is malformed at that frame
+    bool getFrameData(int frame_idx, double *row);
+    bool getPosture(int frame_idx, Posture &posture);
+
+ private:
+    // Move the window to frame_idx and wait for it, the row stays valid while lock is held. nullptr on failure
+    const double *waitFrame(int frame_idx, std::unique_lock<std::mutex> &lock);
+    // Background thread, decodes [decoded_end, window_begin + window) into the ring
+    void readAhead();
+
+    const Skeleton *skeleton;
+    ChannelLayout layout;
+    int window;
+    util::MappedFile file;
+    std::string name;
+    int frame_num = 0;
+    std::vector<AMCFrameOffset> index;
+    // window frames x channels, frame i is stored in row i % window
+    std::vector<double> ring;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable frame_decoded;
+    std::condition_variable window_moved;
+    // Frames [decoded_begin, decoded_end) are in the ring, the thread decodes up to window_begin + window
+    // (guarded by mutex)
+    int window_begin = 0;
+    int decoded_begin = 0;
+    int decoded_end = 0;
+    // Bumped on every seek so the thread drops the frame it is decoding
+    int seek_count = 0;
+    // First frame that failed to parse, frame_num if none
+    int failed_frame = 0;
+    bool stopping = false;
+};
+}  // namespace acclaim
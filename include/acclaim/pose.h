@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "Eigen/StdVector"
+
+#include "posture.h"
+#include "util/helper.h"
+#include "util/rigid_transform.h"
+
+namespace acclaim {
+// Per-evaluation result of forward kinematics, indexed by bone index.
+// Kept apart from the skeleton so one skeleton can be evaluated by many callers at once.
+struct Pose final {
+    Pose() noexcept;
+    explicit Pose(const std::size_t size) noexcept;
+    Pose(const Pose &) noexcept;
+    Pose(Pose &&) noexcept;
+
+    Pose &operator=(const Pose &) noexcept;
+    Pose &operator=(Pose &&) noexcept;
+    // You need this for alignment otherwise it may crash
+    // Ref: https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    // Bone's global rotation, translated to the bone's start pos in global position
+    std::vector<util::RigidTransform> transforms;
+    // Bone's end pos in global position
+    std::vector<Eigen::Vector4d> end_positions;
+    // Bone's local rotation from its AMC channels, converted in one batch before the hierarchy walk
+    std::vector<Eigen::Quaterniond> local_rotations;
+};
+}  // namespace acclaim
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(acclaim::Pose)
@@ -5,7 +5,7 @@
 #include "Eigen/Core"
 #include "Eigen/StdVector"
 
-EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(Eigen::Vector4d)
+#include "util/helper.h"
 
 namespace acclaim {
 struct Posture final {
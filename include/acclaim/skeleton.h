@@ -1,16 +1,16 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "bone.h"
-#include "graphics/cylinder.h"
 #include "util/filesystem.h"
 
-namespace graphics {
-class Program;
-}
-
 namespace acclaim {
+// Immutable rig data (hierarchy, rest transforms and DOFs) loaded from an ASF file.
+// Nothing here changes after construction, so a skeleton can be shared by concurrent FK/IK evaluations.
 class Skeleton final {
  public:
     // Root always has index 0
@@ -24,25 +24,34 @@ class Skeleton final {
     // You need this for alignment otherwise it may crash
     // Ref: https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    // true if the whole ASF file was read, otherwise the skeleton is incomplete and must not be used
+    bool isLoaded() const;
     // get skeleton's scale
     double getScale() const;
     // get total bones in the skeleton
     int getBoneNum() const;
     // get total movable bones in the skeleton
     int getMovableBoneNum() const;
-    // get specific bone by its name
-    Bone *getBonePointer(const std::string &name);
+    // get hash of hierarchy, DOFs and rest transforms, equal skeletons have equal fingerprints
+    std::uint64_t getFingerprint() const;
+    // get specific bone by its name, nullptr if there is no such bone
+    const Bone *getBonePointer(const std::string &name) const;
     // get specific bone by its index
-    Bone *getBonePointer(const int bone_idx);
-    // set bone's color (for rendering)
-    void setBoneColor(const Eigen::Vector4f &boneColor) const;
-    // set bone's model matrices (for rendering)
-    void setModelMatrices() const;
-    // render the bone
-    void render(graphics::Program *program) const;
+    const Bone *getBonePointer(const int bone_idx) const;
+    // Linear part of every bone's global_facing, indexed by bone, contiguous for batch kernels
+    const std::vector<Eigen::Matrix3d> &getBoneFacings() const;
+    // Inverse transpose of getBoneFacings(), so normal matrices never need a per-frame inverse
+    const std::vector<Eigen::Matrix3d> &getBoneNormalFacings() const;
+    // Write the skeleton as an ASF file (bones in their original order, lengths in file units, DOFs and limits
+    // as declared)
+    bool writeASFFile(const util::fs::path &file_name) const;
 
  private:
     bool readASFFile(const util::fs::path &file_name);
+    // Build the name to index table, called once all bones are read
+    void indexBoneNames();
+    // find bone by its name while building the hierarchy
+    Bone *findBone(const std::string &name);
     // This function sets sibling or child for parent bone
     // If parent bone does not have a child,
     // then child is set as parent's child
@@ -55,12 +64,27 @@ class Skeleton final {
     // Calculate rotation from each bone local coordinate system to the coordinate system of its parent
     // store it in rot_parent_current variable for each bone
     void computeLocalRotation();
-    // setup graphics
-    void setBoneGraphics();
+    // Calculate initial rotation and scaling of each bone's cylinder
+    // store it in global_facing variable for each bone
+    void computeGlobalFacing();
+    // Hash everything that kinematics depends on, as read from the ASF file
+    // (derived values may differ in the last bit between compilers and flags)
+    void computeFingerprint();
 
     double scale = 0.2;
+    bool loaded = false;
     int movableBones = 1;
+    std::uint64_t fingerprint = 0;
     std::vector<Bone> bones = std::vector<Bone>(1);
-    mutable std::vector<graphics::Cylinder> bone_graphics;
+    std::vector<Eigen::Matrix3d> bone_facings;
+    std::vector<Eigen::Matrix3d> bone_normal_facings;
+    // Bone name to bone index
+    std::unordered_map<std::string, int> bone_indices;
+    // ASF header kept for writeASFFile(): :units (name, value) pairs in file order, and the :root section whose
+    // orientation is bones[0].axis
+    std::vector<std::pair<std::string, std::string>> units = {{"angle", "deg"}};
+    std::string root_order = "TX TY TZ RX RY RZ";
+    std::string root_axis = "XYZ";
+    Eigen::Vector3d root_position = Eigen::Vector3d::Zero();
 };
 }  // namespace acclaim
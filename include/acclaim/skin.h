@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+
+#include "graphics/skinned_mesh.h"
+#include "pose.h"
+#include "skeleton.h"
+#include "util/filesystem.h"
+#include "util/helper.h"
+#include "util/rigid_transform.h"
+
+namespace acclaim {
+// Mesh bound to a skeleton's rest pose (zero posture, root at the origin) for graphics::SkinnedMesh.
+// Vertex bone indices are skeleton bone indices, so a palette is indexed like Pose::transforms.
+//
+// A .skin file is plain text, positions are in ASF units and get the skeleton's scale:
+//     :bones <count>
+//     <bone name> ...
+//     :vertices <count>
+//     <px py pz> <nx ny nz> <u v> <4 indices into :bones> <4 weights>
+//     :triangles <count>
+//     <3 vertex indices, counter-clockwise>
+class Skin final {
+ public:
+    Skin() noexcept;
+    // Load a .skin file made for skeleton, bones are matched by name
+    Skin(const util::fs::path &skin_file, const Skeleton &skeleton) noexcept;
+    // Wrap every bone in a tube of radius, single-child joints are blended over twice the radius
+    Skin(const Skeleton &skeleton, double radius) noexcept;
+    Skin(const Skin &) noexcept;
+    Skin(Skin &&) noexcept;
+
+    Skin &operator=(const Skin &) noexcept;
+    Skin &operator=(Skin &&) noexcept;
+    // You need this for alignment otherwise it may crash
+    // Ref: https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    // Replace the mesh with skin_file, false (and an empty mesh) on error
+    bool readSkinFile(const util::fs::path &skin_file, const Skeleton &skeleton);
+    const std::vector<graphics::SkinnedVertex> &getVertices() const;
+    const std::vector<GLuint> &getIndices() const;
+    // Skin matrix of every bone: its transform in pose times the inverse of its rest transform
+    void computePalette(const Pose &pose, std::vector<Eigen::AffineCompact3f> &palette) const;
+
+ private:
+    // Evaluate the rest pose and keep its inverse transforms
+    void computeInverseRestTransforms(const Skeleton &skeleton, Pose &rest_pose);
+    // Procedural mesh of the constructor above
+    void generateTubes(const Skeleton &skeleton, const Pose &rest_pose, double radius);
+
+    std::vector<graphics::SkinnedVertex> vertices;
+    std::vector<GLuint> indices;
+    std::vector<util::RigidTransform> inverse_rest_transforms;
+};
+}  // namespace acclaim
@@ -2,8 +2,14 @@
 #include "graphics/box.h"
 #include "graphics/cylinder.h"
 #include "graphics/default_camera.h"
+#include "graphics/frame_uniforms.h"
+#include "graphics/frame_capture.h"
 #include "graphics/free_camera.h"
+#include "graphics/instanced_cylinder.h"
+#include "graphics/level_of_detail.h"
 #include "graphics/plane.h"
+#include "graphics/render_target.h"
 #include "graphics/shader.h"
+#include "graphics/skinned_mesh.h"
 #include "graphics/sphere.h"
 #include "graphics/texture.h"
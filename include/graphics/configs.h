@@ -1,11 +1,23 @@
 #pragma once
 
 namespace graphics {
-inline constexpr int g_SphereSectors = 50;
-inline constexpr int g_SphereStacks = 50;
+// Levels of detail of the procedural meshes, finest first, see LevelOfDetail
+inline constexpr int g_LodLevels = 4;
+// A level is fine enough while its silhouette stays within this many pixels of the true circle
+inline constexpr float g_LodPixelError = 0.5f;
+
+inline constexpr int g_SphereSectors[g_LodLevels] = {50, 32, 16, 8};
+inline constexpr int g_SphereStacks[g_LodLevels] = {50, 16, 8, 4};
 inline constexpr float g_SphereRadius = 1.0f;
 
-inline constexpr int g_CylinderSectors = 72;
+inline constexpr int g_CylinderSectors[g_LodLevels] = {72, 32, 16, 8};
 inline constexpr float g_CylinderHeight = 1.0f;
 inline constexpr float g_CylinderRadius = 0.1f;
+
+// Uniform buffer binding point of the per-frame camera and light block, see FrameUniforms
+inline constexpr unsigned int g_FrameUniformBinding = 0;
+// Uniform buffer binding point of the bone palette, see SkinnedMesh
+inline constexpr unsigned int g_BonePaletteBinding = 1;
+// Palette size of the *_skinned.vert shaders, a std140 mat4 array of this size must fit in 16KB
+inline constexpr int g_MaxSkinBones = 64;
 }  // namespace graphics
@@ -1,7 +1,10 @@
 #pragma once
+#include <array>
 #include <memory>
 
 #include "buffer.h"
+#include "configs.h"
+#include "level_of_detail.h"
 #include "rigidbody.h"
 namespace graphics {
 
@@ -21,10 +24,16 @@ class Cylinder final : public Rigidbody {
     void render(Program* shaderProgram) override;
 
  private:
+    // Instanced drawing reuses the shared mesh
+    friend class InstancedCylinder;
     std::shared_ptr<Buffer<1, GL_ARRAY_BUFFER>> vbo = nullptr;
     std::shared_ptr<Buffer<2, GL_ELEMENT_ARRAY_BUFFER>> ebo = nullptr;
     static std::weak_ptr<Buffer<1, GL_ARRAY_BUFFER>> vbo_weak;
     static std::weak_ptr<Buffer<2, GL_ELEMENT_ARRAY_BUFFER>> ebo_weak;
     static bool isInitialized;
+    // Index range of each level of detail in the element buffer
+    static std::array<LodRange, g_LodLevels> lods;
+    // Radius that LevelOfDetail projects for a cylinder with this linear transform
+    static float boundingRadius(const Eigen::Matrix3f& linear);
 };
 }  // namespace graphics
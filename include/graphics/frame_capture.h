@@ -0,0 +1,69 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "glad/gl.h"
+
+#include "util/filesystem.h"
+
+namespace graphics {
+// Saves rendered frames as a numbered PNG sequence without stalling the render thread.
+// Each capture starts an asynchronous read into one of a ring of pixel pack buffers, which is only mapped when the
+// ring comes around to it again, by then the GPU has long finished. Encoding runs on background threads.
+class FrameCapture final {
+ public:
+    // Frames are written to folder/frame_00000.png, folder/frame_00001.png, ...
+    // latency is the number of frames a readback has before it is mapped
+    explicit FrameCapture(const util::fs::path& folder, int latency = 3) noexcept;
+    // The encoder threads point into this object
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture(FrameCapture&&) = delete;
+    ~FrameCapture();
+
+    FrameCapture& operator=(const FrameCapture&) = delete;
+    FrameCapture& operator=(FrameCapture&&) = delete;
+    // Queue the color buffer of framebuffer (0 for the default one), call after the frame is drawn
+    void capture(GLuint framebuffer, int width, int height);
+    // Wait until every captured frame is written
+    void finish();
+    // Frames captured so far, also the number of the next frame
+    int getFrameCount() const;
+
+ private:
+    struct Readback {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        int frame = 0;
+    };
+    struct Image {
+        std::vector<unsigned char> pixels;
+        int width = 0;
+        int height = 0;
+        int frame = 0;
+    };
+    // Map a finished readback and hand it to the encoders
+    void retire(Readback& readback);
+    // Encoder thread, flips and compresses queued images
+    void encode();
+
+    util::fs::path folder;
+    std::vector<Readback> ring;
+    int frame_count = 0;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable image_queued;
+    std::condition_variable image_done;
+    // (guarded by mutex)
+    std::deque<Image> queue;
+    // Pixel buffers of written images, reused to avoid an allocation per frame
+    std::vector<std::vector<unsigned char>> spare;
+    int encoding = 0;
+    bool stopping = false;
+};
+}  // namespace graphics
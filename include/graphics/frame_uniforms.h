@@ -0,0 +1,45 @@
+#pragma once
+#include "Eigen/Core"
+#include "glad/gl.h"
+
+namespace graphics {
+class Camera;
+class Program;
+// Camera and light state shared by every program through one std140 uniform buffer:
+//     layout(std140) uniform FrameUniforms {
+//         mat4 VP; mat4 view; mat4 projection; mat4 lightSpaceMatrix; vec4 viewPos; vec4 lightPos;
+//     };
+// The buffer stays bound to g_FrameUniformBinding, so a frame costs one buffer update.
+class FrameUniforms final {
+ public:
+    FrameUniforms() noexcept;
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+    ~FrameUniforms();
+
+    static constexpr const char* blockName = "FrameUniforms";
+    // Point program's FrameUniforms block at the shared binding, once after linking.
+    // false if the program declares the block with a different size than Block
+    static bool attach(Program* program);
+
+    void setCamera(const Camera& camera);
+    void setLight(const Eigen::Vector4f& position, const Eigen::Matrix4f& lightSpaceMatrix);
+    // Upload the block if anything changed since the last call
+    void update();
+
+ private:
+    // std140 layout of the block, mat4 is column major like Eigen
+    struct Block {
+        GLfloat VP[16];
+        GLfloat view[16];
+        GLfloat projection[16];
+        GLfloat lightSpaceMatrix[16];
+        GLfloat viewPos[4];
+        GLfloat lightPos[4];
+    };
+    static_assert(sizeof(Block) == 288, "Block must match the std140 layout");
+    GLuint ubo = 0;
+    Block block{};
+    bool isDirty = true;
+};
+}  // namespace graphics
@@ -0,0 +1,65 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "glad/gl.h"
+
+#include "buffer.h"
+#include "util/helper.h"
+
+namespace graphics {
+class Program;
+// Draws many cylinders sharing graphics::Cylinder's mesh with one glDrawElementsInstanced.
+// Model matrix, normal matrix and color of each instance come from vertex attributes 3 to 10,
+// so it must be rendered with the *_instanced.vert shaders.
+class InstancedCylinder final {
+ public:
+    InstancedCylinder() noexcept;
+    explicit InstancedCylinder(int instance_num) noexcept;
+    InstancedCylinder(const InstancedCylinder&) noexcept;
+    InstancedCylinder(InstancedCylinder&&) noexcept;
+
+    InstancedCylinder& operator=(const InstancedCylinder&) noexcept;
+    InstancedCylinder& operator=(InstancedCylinder&&) noexcept;
+    ~InstancedCylinder();
+
+    int getInstanceNum() const;
+    // Changes whenever instance data changes, setting identical values keeps it
+    unsigned int getRevision() const;
+    // New instances are identity transforms with the default color
+    void resize(int instance_num);
+    // One matrix per instance, indexed like the instances, normal matrices are derived by inversion
+    void setModelMatrices(const std::vector<Eigen::AffineCompact3f>& model_matrices);
+    // Same, with normal matrices already computed, see kinematics::boneMatrices
+    void setModelMatrices(const std::vector<Eigen::AffineCompact3f>& model_matrices,
+                          const std::vector<Eigen::Matrix3f>& normal_matrices);
+    void setModelMatrix(int idx, const Eigen::AffineCompact3f& model_matrix);
+    void setModelMatrix(int idx, const Eigen::AffineCompact3f& model_matrix, const Eigen::Matrix3f& normal_matrix);
+    void setColor(const Eigen::Vector4f& color);
+    void setColor(int idx, const Eigen::Vector4f& color);
+    // Uploads changed instances, then draws all of them in one call
+    void render(Program* shaderProgram);
+
+ private:
+    // Layout of the per-instance attributes, column major like GLSL
+    struct Instance {
+        GLfloat model[12];
+        GLfloat normal[9];
+        GLfloat color[4];
+    };
+    void setupVertexArray();
+
+    GLuint vao = 0;
+    GLuint instance_vbo = 0;
+    // Bytes allocated for instance_vbo
+    GLsizeiptr instance_capacity = 0;
+    // Instances changed since the last upload
+    bool isDirty = true;
+    unsigned int revision = 0;
+    std::vector<Instance> instances;
+    std::shared_ptr<Buffer<1, GL_ARRAY_BUFFER>> vbo = nullptr;
+    std::shared_ptr<Buffer<2, GL_ELEMENT_ARRAY_BUFFER>> ebo = nullptr;
+};
+}  // namespace graphics
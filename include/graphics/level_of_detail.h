@@ -0,0 +1,30 @@
+#pragma once
+#include "Eigen/Core"
+#include "glad/gl.h"
+
+namespace graphics {
+// Index range of one level of detail inside a shared element buffer
+struct LodRange {
+    GLsizei count = 0;
+    // Offset of the first index, in indices
+    GLsizei first = 0;
+};
+// Picks mesh levels of detail from the projected size of their bounds in the pass being rendered.
+// Until the first setViewProjection() every draw uses the finest level.
+class LevelOfDetail final {
+ public:
+    LevelOfDetail() = delete;
+    // Set before each pass (camera or light), draws until the next call use it
+    static void setViewProjection(const Eigen::Matrix4f& viewProjection, int viewportWidth, int viewportHeight);
+    // Radius in pixels of a bounding sphere, infinite if the sphere reaches behind the eye
+    static float projectedRadius(const Eigen::Vector3f& center, float radius);
+    // Coarsest level whose polygon of sectors[level] sides stays within g_LodPixelError of a circle of pixelRadius
+    static int select(const int* sectors, float pixelRadius);
+
+ private:
+    // Row of the view projection matrix that gives clip w
+    static Eigen::Vector4f clipW;
+    // Pixels per world unit at clip w = 1
+    static float pixelScale;
+};
+}  // namespace graphics
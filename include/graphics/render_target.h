@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+
+#include "glad/gl.h"
+
+#include "util/filesystem.h"
+
+namespace graphics {
+// Offscreen color and depth buffers, for rendering without a window (e.g. headless mode)
+class RenderTarget final {
+ public:
+    RenderTarget(int width, int height) noexcept;
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+    ~RenderTarget();
+
+    int getWidth() const;
+    int getHeight() const;
+    GLuint getFrameBuffer() const;
+    // Draw into this target instead of the default framebuffer
+    void bind() const;
+    void unbind() const;
+    // Read the color buffer as RGB, rows from top to bottom
+    void readPixels(std::vector<unsigned char>& rgb) const;
+    // Save the color buffer as a binary PPM image
+    bool writePPM(const util::fs::path& file_name) const;
+
+ private:
+    int width = 0;
+    int height = 0;
+    GLuint fbo = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+};
+}  // namespace graphics
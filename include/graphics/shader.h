@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "Eigen/Core"
 #include "Eigen/Geometry"
@@ -24,6 +25,30 @@ class Shader final {
     GLuint id;
 };
 
+// Uniform location resolved once, the type selects the glUniform* call in Program::setUniform
+template <typename T>
+class UniformHandle final {
+ public:
+    UniformHandle() = default;
+    // False if the uniform is not active in the program, setting it is a no-op like location -1
+    bool isValid() const { return location != -1; }
+    GLint getLocation() const { return location; }
+
+ private:
+    friend class Program;
+    explicit UniformHandle(GLint _location) : location(_location) {}
+    GLint location = -1;
+};
+
+// Uniforms every object sets before its draw call, shared by the render and shadow shaders
+struct ObjectUniforms final {
+    UniformHandle<int> useTexture;
+    UniformHandle<int> diffuseTexture;
+    UniformHandle<Eigen::Vector4f> baseColor;
+    UniformHandle<Eigen::Affine3f> model;
+    UniformHandle<Eigen::Matrix4f> invtransmodel;
+};
+
 class Program final {
  public:
     Program();
@@ -43,15 +68,35 @@ class Program final {
     }
 
     GLuint getID() const;
+    // Locations are cached, active uniforms after link() and any other name on first use
     int getUniformLocation(const char* name) const;
+    template <typename T>
+    UniformHandle<T> getUniformHandle(const char* name) const {
+        return UniformHandle<T>(getUniformLocation(name));
+    }
+    // Handles of the per-object uniforms, resolved in link()
+    const ObjectUniforms& getObjectUniforms() const;
+    // Connect a uniform block to a buffer binding point, nothing happens if the block is not active.
+    // Blocks are declared again in every shader, so false (and an error) if this program's copy is not size bytes
+    bool bindUniformBlock(const char* name, GLuint binding, GLint size);
     void use() const;
     void setUniform(const char* name, int i1);
     void setUniform(const char* name, const Eigen::Matrix4f& mat4);
     void setUniform(const char* name, const Eigen::Affine3f& mat4);
     void setUniform(const char* name, const Eigen::Vector3f& vec3);
     void setUniform(const char* name, const Eigen::Vector4f& vec4);
+    // Typed handles skip the name lookup, for per-object updates
+    void setUniform(UniformHandle<int> handle, int i1);
+    void setUniform(UniformHandle<Eigen::Matrix4f> handle, const Eigen::Matrix4f& mat4);
+    void setUniform(UniformHandle<Eigen::Affine3f> handle, const Eigen::Affine3f& mat4);
+    void setUniform(UniformHandle<Eigen::Vector4f> handle, const Eigen::Vector4f& vec4);
 
  private:
+    // Fill uniformLocations with every active uniform
+    void cacheUniformLocations();
     GLuint id;
+    // Sorted by name, so lookups need no allocation
+    mutable std::vector<std::pair<std::string, GLint>> uniformLocations;
+    ObjectUniforms objectUniforms;
 };
 }  // namespace graphics
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "glad/gl.h"
+
+#include "util/helper.h"
+
+namespace graphics {
+class Program;
+// Vertex of a skinned mesh, positions and normals are in the bind pose.
+// Up to four bones influence a vertex, unused influences have zero weight.
+struct SkinnedVertex {
+    GLfloat position[3];
+    GLfloat normal[3];
+    GLfloat texCoord[2];
+    GLubyte bones[4];
+    GLfloat weights[4];
+};
+// Mesh deformed on the GPU with linear blend skinning. The only per-frame CPU work is the bone palette upload:
+//     layout(std140) uniform BonePalette { mat4 bones[g_MaxSkinBones]; };
+// so it must be rendered with the *_skinned.vert shaders.
+class SkinnedMesh final {
+ public:
+    SkinnedMesh() noexcept;
+    SkinnedMesh(const SkinnedMesh&) = delete;
+    SkinnedMesh& operator=(const SkinnedMesh&) = delete;
+    ~SkinnedMesh();
+
+    static constexpr const char* blockName = "BonePalette";
+    // Point program's BonePalette block at the palette binding, once after linking.
+    // false if the program declares the block with another size than g_MaxSkinBones matrices
+    static bool attach(Program* program);
+
+    // Upload the bind pose mesh, bone indices must be below g_MaxSkinBones
+    void setMesh(const std::vector<SkinnedVertex>& vertices, const std::vector<GLuint>& indices);
+    // One rigid skin matrix per bone (current transform times inverse bind transform), see acclaim::Skin.
+    // Only the first g_MaxSkinBones are uploaded
+    void setBonePalette(const std::vector<Eigen::AffineCompact3f>& palette);
+    void setColor(const Eigen::Vector4f& color);
+    // Binds this mesh's palette and draws the whole mesh in one call
+    void render(Program* shaderProgram);
+
+ private:
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    GLuint palette_ubo = 0;
+    GLsizei index_num = 0;
+    // Bones written by the last setBonePalette
+    int palette_size = 0;
+    Eigen::Vector4f baseColor = Eigen::Vector4f(0.7f, 0.75f, 0.85f, 1.0f);
+    // Column major mat4 per bone for std140, the last row stays (0, 0, 0, 1)
+    std::vector<GLfloat> palette_buffer;
+};
+}  // namespace graphics
@@ -1,7 +1,10 @@
 #pragma once
+#include <array>
 #include <memory>
 
 #include "buffer.h"
+#include "configs.h"
+#include "level_of_detail.h"
 #include "rigidbody.h"
 
 namespace graphics {
@@ -27,5 +30,8 @@ class Sphere final : public Rigidbody {
     static std::weak_ptr<Buffer<1, GL_ARRAY_BUFFER>> vbo_weak;
     static std::weak_ptr<Buffer<2, GL_ELEMENT_ARRAY_BUFFER>> ebo_weak;
     static bool isInitialized;
+    // Index ranges of each level of detail in the filled and wireframe element buffers
+    static std::array<LodRange, g_LodLevels> fillLods;
+    static std::array<LodRange, g_LodLevels> wireLods;
 };
 }  // namespace graphics
@@ -43,10 +43,21 @@ class ShadowMapTexture final : public TextureBase {
 
     void bindFrameBuffer() const;
     void unbindFrameBuffer() const;
+    // Static casters are drawn once between begin/endStaticCache, then every frame
+    // restoreStaticCache() resets the shadow map to them before dynamic casters are drawn.
+    // Invalidate the cache when the light or any static caster moves.
+    bool hasStaticCache() const;
+    void beginStaticCache() const;
+    void endStaticCache();
+    void invalidateStaticCache();
+    // Bind the shadow framebuffer with its depth copied from the static cache
+    void restoreStaticCache() const;
 
  private:
     GLuint depthMapFBO;
     unsigned int shadowSize;
+    GLuint staticDepthMap = 0, staticDepthMapFBO = 0;
+    bool isStaticCached = false;
 };
 
 class CubeTexture final : public TextureBase {
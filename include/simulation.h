@@ -1,2 +1,3 @@
 #pragma once
 #include "simulation/ball.h"
+#include "simulation/simulation_thread.h"
@@ -1,17 +1,55 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 
+#include "Eigen/Geometry"
+
+#include "acclaim/bone.h"
+#include "acclaim/pose.h"
 #include "acclaim/posture.h"
+#include "acclaim/skeleton.h"
 
-namespace acclaim {
-struct Bone;
-}
 namespace kinematics {
-// Apply forward kinematics to skeleton
-void forwardSolver(const acclaim::Posture& posture, acclaim::Bone* bone);
+// Write the rotational Jacobian columns (x, y, z) of every bone of one IK chain, three columns per bone from the
+// end bone upwards. Columns of axes without DOF are not written
+using ChainJacobian = void (*)(const acclaim::Pose& pose, const Eigen::Vector4d& target_pos,
+                               Eigen::Matrix4Xd& Jacobian);
+// Kernels specialized for one exact skeleton, emitted at build time by FKGenerator
+struct GeneratedSolver final {
+    // Skeleton::getFingerprint() of the skeleton these kernels are valid for
+    std::uint64_t fingerprint;
+    // Forward kinematics of the whole skeleton
+    void (*forwardSolver)(const acclaim::Posture& posture, acclaim::Pose& pose);
+    // Unrolled Jacobian of every chain, chainJacobians[end bone * bone_num + start bone]. Chains whose start bone
+    // is not an ancestor of the end bone run up to the root, like in inverseJacobianIKSolver
+    int bone_num;
+    const ChainJacobian* chainJacobians;
+};
+// Make a generated solver available to findGeneratedSolver(), called during static initialization
+bool registerGeneratedSolver(const GeneratedSolver* solver);
+// Find the generated solver for a skeleton, nullptr means using the generic path
+const GeneratedSolver* findGeneratedSolver(std::uint64_t fingerprint);
+
+// Apply forward kinematics to the subtree rooted at `bone` and write global transforms into `pose`
+// The skeleton is only read, so concurrent calls are safe as long as each uses its own `pose`
+void forwardSolver(const acclaim::Posture& posture, const acclaim::Bone* bone, acclaim::Pose& pose);
+// Pack every bone's cylinder model matrix (float 3x4) and normal matrix (inverse transpose of its linear part) from
+// an evaluated pose, indexed by bone index. One pass over contiguous arrays, normal matrices reuse the skeleton's
+// precomputed normal facings so no bone is inverted. The output feeds graphics::InstancedCylinder directly.
+void boneMatrices(const acclaim::Skeleton& skeleton, const acclaim::Pose& pose,
+                  std::vector<Eigen::AffineCompact3f>& model_matrices, std::vector<Eigen::Matrix3f>& normal_matrices);
+// Apply forward kinematics to the whole skeleton, then pack its matrices with boneMatrices()
+void forwardSolver(const acclaim::Posture& posture, const acclaim::Skeleton& skeleton, acclaim::Pose& pose,
+                   std::vector<Eigen::AffineCompact3f>& model_matrices, std::vector<Eigen::Matrix3f>& normal_matrices,
+                   const GeneratedSolver* generated = nullptr);
+
+// Generic counterpart of GeneratedSolver::chainJacobians, for the bone_num bones from end_bone upwards
+void chainJacobian(const acclaim::Bone* end_bone, int bone_num, const acclaim::Pose& pose,
+                   const Eigen::Vector4d& target_pos, Eigen::Matrix4Xd& Jacobian);
 
 Eigen::VectorXd pseudoInverseLinearSolver(const Eigen::Matrix4Xd& Jacobian, const Eigen::Vector4d& target);
 
-bool inverseJacobianIKSolver(const Eigen::Vector4d& target_pos, acclaim::Bone* start_bone, acclaim::Bone* end_bone,
-                             acclaim::Posture& posture);
+bool inverseJacobianIKSolver(const Eigen::Vector4d& target_pos, const acclaim::Bone* start_bone,
+                             const acclaim::Bone* end_bone, acclaim::Posture& posture, acclaim::Pose& pose,
+                             const GeneratedSolver* generated = nullptr);
 }  // namespace kinematics
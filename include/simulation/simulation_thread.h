@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+
+#include "acclaim/motion.h"
+#include "acclaim/pose.h"
+#include "util/filesystem.h"
+#include "util/single_producer_queue.h"
+#include "util/triple_buffer.h"
+
+namespace kinematics {
+// A pose published by SimulationThread
+struct SimulationFrame final {
+    acclaim::Pose pose;
+    std::vector<Eigen::AffineCompact3f> model_matrices;
+    std::vector<Eigen::Matrix3f> normal_matrices;
+    // Result of the inverse kinematics that produced this pose
+    bool is_stable = false;
+    // Inputs applied before solving
+    unsigned int input_count = 0;
+    // Increases with every published frame, 0 before the first one
+    unsigned int sequence = 0;
+};
+
+// Runs inverse kinematics on its own thread, so a slow solve never holds up rendering.
+// The render thread sends inputs through a lock-free queue and draws the newest pose from a lock-free triple buffer.
+// Like solving once per rendered frame, an unconverged solve continues each time the renderer takes its last pose.
+class SimulationThread final {
+ public:
+    // motion is copied for solving and for reset(), the first pose is solved before returning
+    SimulationThread(const acclaim::Motion &motion, const Eigen::Vector4d &target, int start_bone,
+                     int end_bone) noexcept;
+    // The simulation thread points into this object
+    SimulationThread(const SimulationThread &) = delete;
+    SimulationThread(SimulationThread &&) = delete;
+    ~SimulationThread();
+
+    SimulationThread &operator=(const SimulationThread &) = delete;
+    SimulationThread &operator=(SimulationThread &&) = delete;
+    // You need this for alignment otherwise it may crash
+    // Ref: https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    // Inputs are applied in order before the next solve, they return false if the queue is full.
+    // Only the render thread may call these and the functions below
+    bool setTarget(const Eigen::Vector4d &target);
+    bool setBones(int start_bone, int end_bone);
+    // Restore the motion given to the constructor
+    bool reset();
+    // Write the edited motion as file_stem.asf and file_stem.amc
+    bool exportMotion(const util::fs::path &file_stem);
+    // Take the newest published frame, false if there is none since the last call
+    bool update();
+    // Wait for the frame that answers every input so far, and for one more step of an unconverged solve.
+    // Frames are then the same as solving on the render thread, e.g. for reproducible headless images
+    void synchronize();
+    // Frame taken by the last update() or synchronize()
+    const SimulationFrame &getFrame() const;
+
+ private:
+    struct Input {
+        enum class Type { Target, Bones, Reset, Export };
+        Type type = Type::Target;
+        Eigen::Vector4d target = Eigen::Vector4d::Zero();
+        int start_bone = 0;
+        int end_bone = 0;
+        util::fs::path file_stem;
+    };
+    bool post(const Input &input);
+    // Solve with the current target and publish the pose
+    void solve();
+    // Simulation thread, applies inputs and solves until destroyed
+    void run();
+
+    // Motion only uses OpenGL when it is copy constructed, rendered or destroyed, which stays on the render thread
+    acclaim::Motion motion;
+    const acclaim::Motion backup;
+    // (simulation thread)
+    Eigen::Vector4d target;
+    int start_bone;
+    int end_bone;
+    bool is_stable = false;
+    unsigned int applied_count = 0;
+    unsigned int sequence = 0;
+    // (render thread)
+    unsigned int posted_count = 0;
+
+    util::SingleProducerQueue<Input, 64> inputs;
+    util::TripleBuffer<SimulationFrame> frames;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+};
+}  // namespace kinematics
@@ -1,3 +1,5 @@
 #pragma once
 #include "util/filesystem.h"
 #include "util/helper.h"
+#include "util/png_writer.h"
+#include "util/rigid_transform.h"
@@ -1,6 +1,15 @@
 #pragma once
+#include <vector>
+
 #include "Eigen/Core"
 #include "Eigen/Geometry"
+#include "Eigen/StdVector"
+
+// Batched kernels take std::vector of these, every translation unit must see the same specialization
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(Eigen::Vector4d)
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(Eigen::Quaterniond)
+// Bone model matrices are stored as float 3x4 (48 bytes each), see kinematics::forwardSolver
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(Eigen::AffineCompact3f)
 
 namespace util {
 // Math constant PI
@@ -35,4 +44,6 @@ Eigen::Quaterniond rotateRadianZYX(const Eigen::Vector4d& rotation);
 Eigen::Quaterniond rotateRadianXYZ(double x, double y, double z);
 // Rotate along Z axis first then Y axis then X axis
 Eigen::Quaterniond rotateRadianXYZ(const Eigen::Vector4d& rotation);
+// Batched rotateDegreeZYX for a whole posture array, quaternions[i] is the rotation of rotations[i]
+void rotateDegreeZYX(const std::vector<Eigen::Vector4d>& rotations, std::vector<Eigen::Quaterniond>& quaternions);
 }  // namespace util
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+
+#include "filesystem.h"
+
+namespace util {
+// Read-only memory mapping of a whole file
+class MappedFile final {
+ public:
+    MappedFile() noexcept;
+    explicit MappedFile(const fs::path& file_name) noexcept;
+    // A mapping has a single owner
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    // Map file_name, any previous mapping is released first
+    bool open(const fs::path& file_name);
+    void close();
+    bool isOpen() const;
+    // get first byte of the file, nullptr if nothing is mapped
+    const char* data() const;
+    // get size of the file in bytes
+    std::size_t size() const;
+
+ private:
+    const char* address = nullptr;
+    std::size_t length = 0;
+    // An empty file cannot be mapped but still opens successfully
+    bool opened = false;
+};
+}  // namespace util
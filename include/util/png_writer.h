@@ -0,0 +1,14 @@
+#pragma once
+#include <vector>
+
+#include "filesystem.h"
+
+namespace util {
+// Minimal PNG encoder for 8-bit RGB and RGBA images.
+// Each row gets the PNG filter with the smallest residuals, then the image is compressed as one deflate block
+// with the fixed Huffman codes and greedy LZ77 matches. Files are larger than zlib's best but several times
+// smaller than raw pixels, and encoding needs no third-party library.
+// pixels holds height rows of width * channels bytes, top row first.
+bool encodePNG(const unsigned char* pixels, int width, int height, int channels, std::vector<unsigned char>& png);
+bool writePNG(const fs::path& file_name, const unsigned char* pixels, int width, int height, int channels);
+}  // namespace util
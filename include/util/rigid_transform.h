@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "Eigen/StdVector"
+
+namespace util {
+// Rotation followed by translation, stored as a unit quaternion and a vector.
+// Composing two costs 28 multiply-adds instead of the 64 of a 4x4 matrix product.
+struct RigidTransform final {
+    RigidTransform() noexcept;
+    RigidTransform(const Eigen::Quaterniond& rotation, const Eigen::Vector3d& translation) noexcept;
+    // You need this for alignment otherwise it may crash
+    // Ref: https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    static RigidTransform Identity();
+    // Apply `other` first, then this
+    RigidTransform operator*(const RigidTransform& other) const;
+    // Transform a point
+    Eigen::Vector3d operator*(const Eigen::Vector3d& point) const;
+    // Transform a homogeneous vector, w = 0 is a direction (rotated only) and w = 1 is a point
+    Eigen::Vector4d operator*(const Eigen::Vector4d& vector) const;
+    RigidTransform inverse() const;
+    // Matrix form, e.g. for the bone palette of acclaim::Skin
+    Eigen::AffineCompact3d toAffine() const;
+
+    Eigen::Quaterniond rotation = Eigen::Quaterniond::Identity();
+    Eigen::Vector3d translation = Eigen::Vector3d::Zero();
+};
+}  // namespace util
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(util::RigidTransform)
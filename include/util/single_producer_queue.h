@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace util {
+// Bounded lock-free FIFO from one producer thread to one consumer thread
+template <typename T, std::size_t capacity>
+class SingleProducerQueue final {
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+ public:
+    SingleProducerQueue() = default;
+    // Threads hold references into the slots
+    SingleProducerQueue(const SingleProducerQueue&) = delete;
+    SingleProducerQueue& operator=(const SingleProducerQueue&) = delete;
+    // Producer only, false if the queue is full
+    bool push(const T& value) {
+        const std::size_t tail_idx = tail.load(std::memory_order_relaxed);
+        if (tail_idx - head.load(std::memory_order_acquire) == capacity) return false;
+        slots[tail_idx & (capacity - 1)] = value;
+        tail.store(tail_idx + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer only, false if the queue is empty
+    bool pop(T& value) {
+        const std::size_t head_idx = head.load(std::memory_order_relaxed);
+        if (head_idx == tail.load(std::memory_order_acquire)) return false;
+        value = std::move(slots[head_idx & (capacity - 1)]);
+        head.store(head_idx + 1, std::memory_order_release);
+        return true;
+    }
+
+ private:
+    std::array<T, capacity> slots;
+    // Each index is written by one thread only, on its own cache line so they do not contend
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+}  // namespace util
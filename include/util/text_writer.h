@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "filesystem.h"
+
+namespace util {
+// Buffered text output to a file, the counterpart of Tokenizer.
+// Numbers are formatted with std::to_chars (shortest representation that reads back to the same value,
+// locale independent) straight into a large buffer that is written out in one call when full.
+class TextWriter final {
+ public:
+    TextWriter() noexcept;
+    explicit TextWriter(const fs::path& file_name) noexcept;
+    TextWriter(const TextWriter&) = delete;
+    TextWriter(TextWriter&&) noexcept;
+    // Flushes buffered text
+    ~TextWriter();
+
+    TextWriter& operator=(const TextWriter&) = delete;
+    TextWriter& operator=(TextWriter&&) noexcept;
+    // Create or truncate file_name, any previous file is closed first
+    bool open(const fs::path& file_name);
+    // Flush and close, false if anything failed to write since open
+    bool close();
+    bool isOpen() const;
+    TextWriter& write(std::string_view text);
+    TextWriter& write(double value);
+    TextWriter& write(int value);
+    TextWriter& put(char c);
+
+ private:
+    // Write the buffer to the file and empty it
+    void flush();
+
+    std::ofstream stream;
+    std::vector<char> buffer;
+    std::size_t used = 0;
+    bool failed = false;
+};
+}  // namespace util
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace util {
+// Whitespace separated tokens over text in memory (usually a MappedFile).
+// Numbers are parsed with std::from_chars, so parsing is locale independent and never allocates.
+// Line and column of the last token are tracked for error messages.
+class Tokenizer final {
+ public:
+    // name is only used in error messages, first_line is the line number of begin
+    Tokenizer(const char* begin, const char* end, const std::string& name = std::string(), int first_line = 1) noexcept;
+    // true if only whitespace is left
+    bool eof();
+    // get next token, empty at end of input
+    std::string_view next();
+    // get next token on the current line, empty if the line has no more tokens (the line end is not consumed)
+    std::string_view nextInLine();
+    // Parse next token as a number, reports an error if the token is not a number
+    bool next(double& value);
+    bool next(int& value);
+    // get rest of the current line without the line break and move to the next line
+    std::string_view line();
+    // Move to the beginning of the next line
+    void skipLine();
+    // Print "name:line:column: message" for the last token to std::cerr
+    void error(const std::string& message) const;
+    // get line (1-based) of the last token
+    int getLine() const;
+    // get column (1-based) of the last token
+    int getColumn() const;
+    // get current read position
+    const char* position() const;
+
+ private:
+    // Skip whitespace, stopping at line breaks if stop_at_newline is set
+    void skipWhitespace(bool stop_at_newline);
+    std::string_view readToken();
+
+    const char* current;
+    const char* end;
+    std::string name;
+    // Start of the line being read and its number
+    const char* line_begin;
+    int line_number = 1;
+    // Position of the last token
+    int token_line = 1;
+    int token_column = 1;
+};
+}  // namespace util
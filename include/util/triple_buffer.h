@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+namespace util {
+// Lock-free handoff of the latest value from one writer thread to one reader thread.
+// The writer fills back() and publishes it, the reader takes the newest published value with update().
+// Neither side ever waits, values the reader was too slow to take are overwritten.
+template <typename T>
+class TripleBuffer final {
+ public:
+    TripleBuffer() = default;
+    // Threads hold references into the slots
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+    // Writer only: the slot to fill, it holds an old value that was published before
+    T& back() { return slots[back_idx]; }
+    // Writer only: hand back() to the reader
+    void publish() { back_idx = middle.exchange(back_idx | fresh_bit, std::memory_order_acq_rel) & index_mask; }
+    // Writer only: true while the last published value has not been taken
+    bool hasUnread() const { return (middle.load(std::memory_order_acquire) & fresh_bit) != 0; }
+    // Reader only: take the newest published value, false if there is none since the last call
+    bool update() {
+        if (!hasUnread()) return false;
+        front_idx = middle.exchange(front_idx, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+    // Reader only: the value taken by the last update()
+    const T& front() const { return slots[front_idx]; }
+
+ private:
+    static constexpr int index_mask = 3;
+    static constexpr int fresh_bit = 4;
+    std::array<T, 3> slots;
+    // Slot between the two threads, with fresh_bit set when the writer published it
+    std::atomic<int> middle{1};
+    int front_idx = 0;
+    int back_idx = 2;
+};
+}  // namespace util
@@ -0,0 +1,129 @@
+#include "acclaim/amc_parser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+#include "util/mapped_file.h"
+
+namespace acclaim {
+int indexAMCFrames(const char *begin, const char *end, int stride, std::vector<AMCFrameOffset> &offsets) {
+    int frame_num = 0;
+    int line = 1;
+    const char *current = begin;
+    while (current < end) {
+        if (*current >= '0' && *current <= '9') {
+            if (frame_num % stride == 0) offsets.push_back({current, line});
+            ++frame_num;
+        }
+        const char *line_end = static_cast<const char *>(std::memchr(current, '\n', end - current));
+        if (line_end == nullptr) break;
+        current = line_end + 1;
+        ++line;
+    }
+    return frame_num;
+}
+
+AMCParser::AMCParser(const Skeleton &_skeleton, const ChannelLayout &_layout, const char *begin, const char *end,
+                     const std::string &name, int first_line) noexcept
+    : skeleton(&_skeleton),
+      layout(&_layout),
+      tokenizer(begin, end, name, first_line),
+      line_bones(_skeleton.getMovableBoneNum(), nullptr) {
+    for (int k = 0; k < 3; ++k) {
+        root_translations[k] = _layout.getChannelIndex(Skeleton::root_idx(), static_cast<ChannelType>(k));
+    }
+}
+
+void AMCParser::readHeader() {
+    while (!tokenizer.eof() && (*tokenizer.position() == '#' || *tokenizer.position() == ':')) {
+        tokenizer.skipLine();
+    }
+}
+
+bool AMCParser::eof() { return tokenizer.eof(); }
+
+bool AMCParser::readFrame(double *row) {
+    if (!tokenizer.next(frame_number)) return false;
+    for (std::size_t i = 0; i < line_bones.size(); ++i) {
+        const std::string_view bone_name = tokenizer.next();
+        if (bone_name.empty()) {
+            tokenizer.error("unexpected end of file in frame " + std::to_string(frame_number));
+            return false;
+        }
+        if (line_bones[i] == nullptr || line_bones[i]->name != bone_name) {
+            line_bones[i] = skeleton->getBonePointer(std::string(bone_name));
+            if (line_bones[i] == nullptr) {
+                tokenizer.error("unknown bone \"" + std::string(bone_name) + "\"");
+                return false;
+            }
+        }
+        // Channels are stored in the same order as they appear in the line
+        const int bone_idx = line_bones[i]->idx;
+        double *channels = row + layout->getBoneOffset(bone_idx);
+        const int channel_num = layout->getBoneChannelNum(bone_idx);
+        for (int k = 0; k < channel_num; ++k) {
+            if (!tokenizer.next(channels[k])) return false;
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        if (root_translations[k] >= 0) row[root_translations[k]] *= skeleton->getScale();
+    }
+    return true;
+}
+
+int AMCParser::getFrameNumber() const { return frame_number; }
+
+const std::vector<const Bone *> &AMCParser::getLineBones() const { return line_bones; }
+
+const char *AMCParser::position() const { return tokenizer.position(); }
+
+bool readAMCFile(const util::fs::path &file_name, const Skeleton &skeleton, MotionClip &clip, int thread_num) {
+    util::MappedFile file;
+    if (!file.open(file_name)) return false;
+    const char *end = file.data() + file.size();
+    // Frames are independent text blocks, so the file is split at frame lines into chunks that are
+    // parsed in parallel, each straight into its own rows
+    constexpr int chunk_frames = 64;
+    std::vector<AMCFrameOffset> chunks;
+    const int frame_num = indexAMCFrames(file.data(), end, chunk_frames, chunks);
+    clip.resize(frame_num);
+    const int channel_num = clip.getChannelNum();
+    double *rows = frame_num > 0 ? clip.getFrameData(0) : nullptr;
+    // Only the thread of the first chunk writes this
+    std::vector<int> bone_order;
+    auto parse = [&](int first_chunk, int last_chunk) {
+        const AMCFrameOffset &start = chunks[first_chunk];
+        AMCParser parser(skeleton, clip.getLayout(), start.position, end, file_name.string(), start.line);
+        const int last_frame = std::min(last_chunk * chunk_frames, frame_num);
+        for (int frame = first_chunk * chunk_frames; frame < last_frame; ++frame) {
+            if (!parser.readFrame(rows + static_cast<std::size_t>(frame) * channel_num)) return false;
+        }
+        if (first_chunk == 0) {
+            for (const Bone *bone : parser.getLineBones()) bone_order.push_back(bone->idx);
+        }
+        return true;
+    };
+    const int chunk_num = static_cast<int>(chunks.size());
+    if (thread_num <= 0) thread_num = static_cast<int>(std::thread::hardware_concurrency());
+    thread_num = std::clamp(thread_num, 1, std::max(chunk_num, 1));
+    const int chunks_per_thread = (chunk_num + thread_num - 1) / thread_num;
+    // Rounding up can leave the trailing threads without chunks, e.g. 5 chunks on 4 threads is 2 + 2 + 1
+    if (chunk_num > 0) thread_num = (chunk_num + chunks_per_thread - 1) / chunks_per_thread;
+    std::vector<char> results(thread_num, 1);
+    std::vector<std::thread> workers;
+    for (int i = 1; i < thread_num; ++i) {
+        workers.emplace_back([&, i] {
+            results[i] = parse(i * chunks_per_thread, std::min((i + 1) * chunks_per_thread, chunk_num));
+        });
+    }
+    if (chunk_num > 0) results[0] = parse(0, std::min(chunks_per_thread, chunk_num));
+    for (std::thread &worker : workers) worker.join();
+    if (std::find(results.begin(), results.end(), 0) != results.end()) return false;
+    clip.setBoneOrder(std::move(bone_order));
+    std::cout << frame_num << " samples in " << file_name.string() << " are read" << std::endl;
+    return true;
+}
+}  // namespace acclaim
@@ -0,0 +1,108 @@
+#include "acclaim/channel_layout.h"
+
+#include <utility>
+
+#include "acclaim/skeleton.h"
+
+namespace acclaim {
+ChannelLayout::ChannelLayout() noexcept {}
+
+ChannelLayout::ChannelLayout(const Skeleton &skeleton) noexcept {
+    const int bone_num = skeleton.getBoneNum();
+    channel_indices.resize(bone_num);
+    bone_offsets.resize(bone_num + 1);
+    for (int i = 0; i < bone_num; ++i) {
+        const Bone *bone = skeleton.getBonePointer(i);
+        const bool dofs[6] = {bone->doftx, bone->dofty, bone->doftz, bone->dofrx, bone->dofry, bone->dofrz};
+        bone_offsets[i] = static_cast<int>(channel_types.size());
+        for (int type = 0; type < 6; ++type) {
+            if (!dofs[type]) {
+                channel_indices[i][type] = -1;
+                continue;
+            }
+            channel_indices[i][type] = static_cast<int>(channel_types.size());
+            channel_bones.push_back(i);
+            channel_types.push_back(static_cast<ChannelType>(type));
+        }
+    }
+    bone_offsets[bone_num] = static_cast<int>(channel_types.size());
+}
+
+ChannelLayout::ChannelLayout(const ChannelLayout &other) noexcept
+    : channel_indices(other.channel_indices),
+      bone_offsets(other.bone_offsets),
+      channel_bones(other.channel_bones),
+      channel_types(other.channel_types) {}
+
+ChannelLayout::ChannelLayout(ChannelLayout &&other) noexcept
+    : channel_indices(std::move(other.channel_indices)),
+      bone_offsets(std::move(other.bone_offsets)),
+      channel_bones(std::move(other.channel_bones)),
+      channel_types(std::move(other.channel_types)) {}
+
+ChannelLayout &ChannelLayout::operator=(const ChannelLayout &other) noexcept {
+    if (this != &other) {
+        channel_indices = other.channel_indices;
+        bone_offsets = other.bone_offsets;
+        channel_bones = other.channel_bones;
+        channel_types = other.channel_types;
+    }
+    return *this;
+}
+
+ChannelLayout &ChannelLayout::operator=(ChannelLayout &&other) noexcept {
+    if (this != &other) {
+        channel_indices = std::move(other.channel_indices);
+        bone_offsets = std::move(other.bone_offsets);
+        channel_bones = std::move(other.channel_bones);
+        channel_types = std::move(other.channel_types);
+    }
+    return *this;
+}
+
+bool ChannelLayout::operator==(const ChannelLayout &other) const {
+    // Everything else is derived from these two
+    return channel_bones == other.channel_bones && channel_types == other.channel_types &&
+           getBoneNum() == other.getBoneNum();
+}
+
+bool ChannelLayout::operator!=(const ChannelLayout &other) const { return !(*this == other); }
+
+int ChannelLayout::getChannelNum() const { return static_cast<int>(channel_types.size()); }
+
+int ChannelLayout::getBoneNum() const { return static_cast<int>(channel_indices.size()); }
+
+int ChannelLayout::getBoneOffset(const int bone_idx) const { return bone_offsets[bone_idx]; }
+
+int ChannelLayout::getBoneChannelNum(const int bone_idx) const {
+    return bone_offsets[bone_idx + 1] - bone_offsets[bone_idx];
+}
+
+int ChannelLayout::getChannelIndex(const int bone_idx, const ChannelType type) const {
+    return channel_indices[bone_idx][static_cast<int>(type)];
+}
+
+int ChannelLayout::getChannelBone(const int channel) const { return channel_bones[channel]; }
+
+ChannelType ChannelLayout::getChannelType(const int channel) const { return channel_types[channel]; }
+
+void ChannelLayout::unpack(const double *row, Posture &posture) const {
+    const std::size_t bone_num = channel_indices.size();
+    if (posture.bone_rotations.size() != bone_num) posture = Posture(bone_num);
+    for (std::size_t i = 0; i < bone_num; ++i) {
+        const std::array<int, 6> &indices = channel_indices[i];
+        for (int k = 0; k < 3; ++k) {
+            posture.bone_translations[i][k] = indices[k] < 0 ? 0.0 : row[indices[k]];
+            posture.bone_rotations[i][k] = indices[k + 3] < 0 ? 0.0 : row[indices[k + 3]];
+        }
+    }
+}
+
+void ChannelLayout::pack(const Posture &posture, double *row) const {
+    for (std::size_t channel = 0; channel < channel_types.size(); ++channel) {
+        const int type = static_cast<int>(channel_types[channel]);
+        const int bone_idx = channel_bones[channel];
+        row[channel] = type < 3 ? posture.bone_translations[bone_idx][type] : posture.bone_rotations[bone_idx][type - 3];
+    }
+}
+}  // namespace acclaim
@@ -0,0 +1,236 @@
+#include "acclaim/compressed_clip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "Eigen/Core"
+
+#include "util/helper.h"
+
+namespace acclaim {
+namespace {
+constexpr double max_quantized = 65535.0;
+constexpr double max_wide_quantized = 4294967295.0;
+
+// Longest distance from the start of bone to the end of any bone below it, summed over lengths so it holds
+// in every pose
+double boneReach(const Bone *bone) {
+    double reach = 0.0;
+    for (const Bone *child = bone->child; child != nullptr; child = child->sibling) {
+        reach = std::max(reach, boneReach(child));
+    }
+    return bone->length + reach;
+}
+
+// Most channels on any path from bone down to a leaf
+int chainChannels(const Bone *bone, const ChannelLayout &layout) {
+    int channels = 0;
+    for (const Bone *child = bone->child; child != nullptr; child = child->sibling) {
+        channels = std::max(channels, chainChannels(child, layout));
+    }
+    return layout.getBoneChannelNum(bone->idx) + channels;
+}
+
+// Value tolerance of each channel. A rotation error of e radians moves every bone end below the joint by at
+// most e * reach, a translation error moves them by e. Errors of all channels on a chain add up, so each
+// channel gets an equal share of the world-space tolerance.
+std::vector<double> channelTolerances(const Skeleton &skeleton, const ChannelLayout &layout, double tolerance) {
+    const Bone *root = skeleton.getBonePointer(Skeleton::root_idx());
+    const double share = tolerance / std::max(chainChannels(root, layout), 1);
+    std::vector<double> tolerances(layout.getChannelNum());
+    for (int channel = 0; channel < layout.getChannelNum(); ++channel) {
+        if (layout.getChannelType(channel) <= ChannelType::TZ) {
+            tolerances[channel] = share;
+        } else {
+            const double reach = boneReach(skeleton.getBonePointer(layout.getChannelBone(channel)));
+            tolerances[channel] = reach > 0.0 ? share / reach * 180.0 / util::PI : std::numeric_limits<double>::max();
+        }
+    }
+    return tolerances;
+}
+}  // namespace
+
+CompressedClip::CompressedClip() noexcept : key_offsets(1, 0) {}
+
+CompressedClip::CompressedClip(const MotionClip &clip, const Skeleton &skeleton, double tolerance) noexcept
+    : layout(clip.getLayout()),
+      frame_num(clip.getFrameNum()),
+      frame_rate(clip.getFrameRate()),
+      minimums(clip.getChannelNum(), 0.0),
+      steps(clip.getChannelNum(), 0.0),
+      key_offsets(1, 0),
+      value_offsets(clip.getChannelNum(), 0),
+      wide_channels(clip.getChannelNum(), 0) {
+    const int channel_num = layout.getChannelNum();
+    const std::vector<double> tolerances = channelTolerances(skeleton, layout, tolerance);
+    std::vector<double> values(frame_num);
+    std::vector<std::uint32_t> quantized(frame_num);
+    for (int channel = 0; channel < channel_num; ++channel) {
+        for (int frame = 0; frame < frame_num; ++frame) values[frame] = clip.getFrameData(frame)[channel];
+        if (frame_num > 0) {
+            const auto [low, high] = std::minmax_element(values.begin(), values.end());
+            minimums[channel] = *low;
+            steps[channel] = (*high - *low) / max_quantized;
+        }
+        // Keys are off by up to half a step, which the keyframe reduction below cannot make up for
+        const bool wide = steps[channel] * 0.5 > tolerances[channel];
+        if (wide) steps[channel] *= max_quantized / max_wide_quantized;
+        wide_channels[channel] = wide;
+        value_offsets[channel] = static_cast<std::uint32_t>(wide ? wide_key_values.size() : key_values.size());
+        const double step = steps[channel];
+        for (int frame = 0; frame < frame_num; ++frame) {
+            quantized[frame] =
+                step > 0.0 ? static_cast<std::uint32_t>(std::llround((values[frame] - minimums[channel]) / step)) : 0;
+        }
+        // Greedy keyframe reduction: extend each segment while the line between its end keys stays within
+        // tolerance of every frame in between. The lines from the start key that pass all frames so far form
+        // a range of slopes, so each frame is checked once.
+        const double allowed = tolerances[channel];
+        int key = 0;
+        while (frame_num > 0) {
+            key_frames.push_back(static_cast<std::uint32_t>(key));
+            if (wide) {
+                wide_key_values.push_back(quantized[key]);
+            } else {
+                key_values.push_back(static_cast<std::uint16_t>(quantized[key]));
+            }
+            if (key == frame_num - 1) break;
+            const double start = minimums[channel] + step * quantized[key];
+            double min_slope = -std::numeric_limits<double>::infinity();
+            double max_slope = std::numeric_limits<double>::infinity();
+            int end = key + 1;
+            for (int frame = key + 1; frame < frame_num; ++frame) {
+                const double distance = frame - key;
+                const double slope = (minimums[channel] + step * quantized[frame] - start) / distance;
+                if (slope >= min_slope && slope <= max_slope) end = frame;
+                min_slope = std::max(min_slope, (values[frame] - allowed - start) / distance);
+                max_slope = std::min(max_slope, (values[frame] + allowed - start) / distance);
+                if (min_slope > max_slope) break;
+            }
+            key = end;
+        }
+        key_offsets.push_back(static_cast<std::uint32_t>(key_frames.size()));
+    }
+}
+
+CompressedClip::CompressedClip(const CompressedClip &other) noexcept
+    : layout(other.layout),
+      frame_num(other.frame_num),
+      frame_rate(other.frame_rate),
+      minimums(other.minimums),
+      steps(other.steps),
+      key_offsets(other.key_offsets),
+      key_frames(other.key_frames),
+      value_offsets(other.value_offsets),
+      wide_channels(other.wide_channels),
+      key_values(other.key_values),
+      wide_key_values(other.wide_key_values) {}
+
+CompressedClip::CompressedClip(CompressedClip &&other) noexcept
+    : layout(std::move(other.layout)),
+      frame_num(std::exchange(other.frame_num, 0)),
+      frame_rate(other.frame_rate),
+      minimums(std::move(other.minimums)),
+      steps(std::move(other.steps)),
+      key_offsets(std::move(other.key_offsets)),
+      key_frames(std::move(other.key_frames)),
+      value_offsets(std::move(other.value_offsets)),
+      wide_channels(std::move(other.wide_channels)),
+      key_values(std::move(other.key_values)),
+      wide_key_values(std::move(other.wide_key_values)) {}
+
+CompressedClip &CompressedClip::operator=(const CompressedClip &other) noexcept {
+    if (this != &other) {
+        layout = other.layout;
+        frame_num = other.frame_num;
+        frame_rate = other.frame_rate;
+        minimums = other.minimums;
+        steps = other.steps;
+        key_offsets = other.key_offsets;
+        key_frames = other.key_frames;
+        value_offsets = other.value_offsets;
+        wide_channels = other.wide_channels;
+        key_values = other.key_values;
+        wide_key_values = other.wide_key_values;
+    }
+    return *this;
+}
+
+CompressedClip &CompressedClip::operator=(CompressedClip &&other) noexcept {
+    if (this != &other) {
+        layout = std::move(other.layout);
+        frame_num = std::exchange(other.frame_num, 0);
+        frame_rate = other.frame_rate;
+        minimums = std::move(other.minimums);
+        steps = std::move(other.steps);
+        key_offsets = std::move(other.key_offsets);
+        key_frames = std::move(other.key_frames);
+        value_offsets = std::move(other.value_offsets);
+        wide_channels = std::move(other.wide_channels);
+        key_values = std::move(other.key_values);
+        wide_key_values = std::move(other.wide_key_values);
+    }
+    return *this;
+}
+
+const ChannelLayout &CompressedClip::getLayout() const { return layout; }
+
+int CompressedClip::getFrameNum() const { return frame_num; }
+
+int CompressedClip::getChannelNum() const { return layout.getChannelNum(); }
+
+double CompressedClip::getFrameRate() const { return frame_rate; }
+
+int CompressedClip::getKeyNum() const { return static_cast<int>(key_frames.size()); }
+
+std::size_t CompressedClip::getMemorySize() const {
+    return (minimums.size() + steps.size()) * sizeof(double) + key_offsets.size() * sizeof(std::uint32_t) +
+           key_frames.size() * sizeof(std::uint32_t) + value_offsets.size() * sizeof(std::uint32_t) +
+           wide_channels.size() * sizeof(std::uint8_t) + key_values.size() * sizeof(std::uint16_t) +
+           wide_key_values.size() * sizeof(std::uint32_t);
+}
+
+bool CompressedClip::isWideChannel(const int channel) const { return wide_channels[channel] != 0; }
+
+double CompressedClip::getKeyValue(const int channel, const std::size_t k) const {
+    const std::size_t value = value_offsets[channel] + k;
+    return wide_channels[channel] ? wide_key_values[value] : key_values[value];
+}
+
+void CompressedClip::decode(const int frame_idx, double *row) const {
+    const int channel_num = layout.getChannelNum();
+    const std::uint32_t frame = static_cast<std::uint32_t>(frame_idx);
+    // Interpolate the quantized keys around the frame, then dequantize all channels at once
+    for (int channel = 0; channel < channel_num; ++channel) {
+        const std::uint32_t *first = key_frames.data() + key_offsets[channel];
+        const std::uint32_t *last = key_frames.data() + key_offsets[channel + 1];
+        const std::uint32_t *next = std::upper_bound(first + 1, last, frame);
+        if (next == last) {
+            row[channel] = getKeyValue(channel, last - 1 - first);
+            continue;
+        }
+        const std::size_t k = next - 1 - first;
+        const double t = static_cast<double>(frame - first[k]) / (first[k + 1] - first[k]);
+        const double start = getKeyValue(channel, k);
+        row[channel] = start + t * (getKeyValue(channel, k + 1) - start);
+    }
+    Eigen::Map<Eigen::ArrayXd> values(row, channel_num);
+    values = Eigen::Map<const Eigen::ArrayXd>(minimums.data(), channel_num) +
+             Eigen::Map<const Eigen::ArrayXd>(steps.data(), channel_num) * values;
+}
+
+void CompressedClip::decode(const int frame_idx, double *row, Posture &posture) const {
+    decode(frame_idx, row);
+    layout.unpack(row, posture);
+}
+
+MotionClip CompressedClip::decompress() const {
+    MotionClip clip(layout);
+    clip.setFrameRate(frame_rate);
+    clip.resize(frame_num);
+    for (int frame = 0; frame < frame_num; ++frame) decode(frame, clip.getFrameData(frame));
+    return clip;
+}
+}  // namespace acclaim
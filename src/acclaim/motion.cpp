@@ -1,33 +1,59 @@
 #include "acclaim/motion.h"
-#include <fstream>
 #include <iostream>
 #include <utility>
 
+#include "acclaim/motion_cache.h"
 #include "simulation/kinematics.h"
+#include "util/text_writer.h"
 
 namespace acclaim {
-Motion::Motion(const util::fs::path &amc_file, std::unique_ptr<Skeleton> &&_skeleton) noexcept
-    : skeleton(std::move(_skeleton)) {
-    postures.reserve(1024);
+Motion::Motion(const util::fs::path &amc_file, std::shared_ptr<const Skeleton> _skeleton) noexcept
+    : skeleton(std::move(_skeleton)), clip(ChannelLayout(*skeleton)), posture(skeleton->getBoneNum()) {
     if (!this->readAMCFile(amc_file)) {
         std::cerr << "Error in reading AMC file, this object is not initialized!" << std::endl;
         std::cerr << "You can call readAMCFile() to initialize again" << std::endl;
-        postures.resize(0);
+        clip.resize(0);
     }
+    initialize();
 }
 
-const std::unique_ptr<Skeleton> &Motion::getSkeleton() const { return skeleton; }
+Motion::Motion(const MotionClip &_clip, std::shared_ptr<const Skeleton> _skeleton) noexcept
+    : skeleton(std::move(_skeleton)), clip(_clip), posture(skeleton->getBoneNum()) {
+    initialize();
+}
+
+const std::shared_ptr<const Skeleton> &Motion::getSkeleton() const { return skeleton; }
 
 Motion::Motion(const Motion &other) noexcept
-    : skeleton(std::make_unique<Skeleton>(*other.skeleton)), postures(other.postures) {}
+    : skeleton(other.skeleton),
+      clip(other.clip),
+      posture(other.posture),
+      pose(other.pose),
+      model_matrices(other.model_matrices),
+      normal_matrices(other.normal_matrices),
+      bone_graphics(other.bone_graphics),
+      generated_solver(other.generated_solver) {}
 
-Motion::Motion(Motion &&other) noexcept : skeleton(std::move(other.skeleton)), postures(std::move(other.postures)) {}
+Motion::Motion(Motion &&other) noexcept
+    : skeleton(std::move(other.skeleton)),
+      clip(std::move(other.clip)),
+      posture(std::move(other.posture)),
+      pose(std::move(other.pose)),
+      model_matrices(std::move(other.model_matrices)),
+      normal_matrices(std::move(other.normal_matrices)),
+      bone_graphics(std::move(other.bone_graphics)),
+      generated_solver(other.generated_solver) {}
 
 Motion &Motion::operator=(const Motion &other) noexcept {
     if (this != &other) {
-        skeleton.reset();
-        skeleton = std::make_unique<Skeleton>(*other.skeleton);
-        postures = other.postures;
+        skeleton = other.skeleton;
+        clip = other.clip;
+        posture = other.posture;
+        pose = other.pose;
+        model_matrices = other.model_matrices;
+        normal_matrices = other.normal_matrices;
+        bone_graphics = other.bone_graphics;
+        generated_solver = other.generated_solver;
     }
     return *this;
 }
@@ -35,77 +61,112 @@ Motion &Motion::operator=(const Motion &other) noexcept {
 Motion &Motion::operator=(Motion &&other) noexcept {
     if (this != &other) {
         skeleton = std::move(other.skeleton);
-        postures = std::move(other.postures);
+        clip = std::move(other.clip);
+        posture = std::move(other.posture);
+        pose = std::move(other.pose);
+        model_matrices = std::move(other.model_matrices);
+        normal_matrices = std::move(other.normal_matrices);
+        bone_graphics = std::move(other.bone_graphics);
+        generated_solver = other.generated_solver;
     }
     return *this;
 }
 
-int Motion::getFrameNum() const { return static_cast<int>(postures.size()); }
+int Motion::getFrameNum() const { return clip.getFrameNum(); }
+
+const Pose &Motion::getPose() const { return pose; }
+
+const std::vector<Eigen::AffineCompact3f> &Motion::getModelMatrices() const { return model_matrices; }
+
+const std::vector<Eigen::Matrix3f> &Motion::getNormalMatrices() const { return normal_matrices; }
+
+void Motion::setPose(const Pose &_pose, const std::vector<Eigen::AffineCompact3f> &_model_matrices,
+                     const std::vector<Eigen::Matrix3f> &_normal_matrices) {
+    pose = _pose;
+    model_matrices = _model_matrices;
+    normal_matrices = _normal_matrices;
+    setModelMatrices();
+}
+
+const MotionClip &Motion::getClip() const { return clip; }
 
 void Motion::forwardkinematics(int frame_idx) {
-    kinematics::forwardSolver(postures[frame_idx], skeleton->getBonePointer(0));
-    skeleton->setModelMatrices();
+    clip.getPosture(frame_idx).toPosture(posture);
+    kinematics::forwardSolver(posture, *skeleton, pose, model_matrices, normal_matrices, generated_solver);
+    setModelMatrices();
 }
 
 bool Motion::inverseKinematics(const Eigen::Vector4d &target, int start, int end) {
+    clip.getPosture(0).toPosture(posture);
     bool result = kinematics::inverseJacobianIKSolver(target, skeleton->getBonePointer(start),
-                                                      skeleton->getBonePointer(end), postures[0]);
-    skeleton->setModelMatrices();
+                                                      skeleton->getBonePointer(end), posture, pose, generated_solver);
+    // Jacobian columns of non-DOF axes are zero, so the edit fits back into the DOF channels losslessly
+    clip.setPosture(0, posture);
+    kinematics::forwardSolver(posture, *skeleton, pose, model_matrices, normal_matrices, generated_solver);
+    setModelMatrices();
     return result;
 }
 
-bool Motion::readAMCFile(const util::fs::path &file_name) {
-    // Open AMC file
-    std::ifstream input_stream(file_name);
-    // Check if file successfully opened
-    if (!input_stream) {
-        std::cerr << "Failed to open " << file_name << std::endl;
-        return false;
+void Motion::setBoneColor(const Eigen::Vector4f &boneColor) const {
+    bone_graphics.setColor(boneColor);
+}
+
+void Motion::setModelMatrices() const { bone_graphics.setModelMatrices(model_matrices, normal_matrices); }
+
+void Motion::initialize() {
+    clip.shrinkToFit();
+    pose = Pose(skeleton->getBoneNum());
+    generated_solver = kinematics::findGeneratedSolver(skeleton->getFingerprint());
+    if (generated_solver != nullptr) {
+        std::cout << "Skeleton matches the generated kinematics solver" << std::endl;
     }
-    // There are (NUM_BONES_IN_ASF_FILE - 2) moving bones and 2 dummy bones (lhipjoint and rhipjoint)
-    int movable_bones = skeleton->getMovableBoneNum();
-    // Ignore header
-    input_stream.ignore(1024, '\n');
-    input_stream.ignore(1024, '\n');
-    input_stream.ignore(1024, '\n');
-    int frame_num;
-    std::string bone_name;
-    while (input_stream >> frame_num) {
-        auto &&current_posture = postures.emplace_back(skeleton->getBoneNum());
-        for (int i = 0; i < movable_bones; ++i) {
-            input_stream >> bone_name;
-            const Bone &bone = *skeleton->getBonePointer(bone_name);
-            int bone_idx = bone.idx;
-            Eigen::Vector4d bone_rotation = Eigen::Vector4d::Zero();
-            Eigen::Vector4d bone_translation = Eigen::Vector4d::Zero();
-            if (bone.doftx) {
-                input_stream >> bone_translation[0];
-            }
-            if (bone.dofty) {
-                input_stream >> bone_translation[1];
-            }
-            if (bone.doftz) {
-                input_stream >> bone_translation[2];
-            }
-            if (bone.dofrx) {
-                input_stream >> bone_rotation[0];
-            }
-            if (bone.dofry) {
-                input_stream >> bone_rotation[1];
-            }
-            if (bone.dofrz) {
-                input_stream >> bone_rotation[2];
-            }
-            current_posture.bone_rotations[bone_idx] = std::move(bone_rotation);
-            current_posture.bone_translations[bone_idx] = std::move(bone_translation);
-            if (bone_idx == 0) {
-                current_posture.bone_translations[bone_idx] *= skeleton->getScale();
+    setBoneGraphics();
+}
+
+void Motion::setBoneGraphics() {
+    bone_graphics.resize(skeleton->getBoneNum());
+    bone_graphics.setColor(Eigen::Vector4f(0.6f, 0.6f, 0.0f, 1.0f));
+}
+
+bool Motion::readAMCFile(const util::fs::path &file_name) { return loadMotionClip(file_name, *skeleton, clip); }
+
+bool Motion::writeAMCFile(const util::fs::path &file_name) const {
+    util::TextWriter writer;
+    if (!writer.open(file_name)) return false;
+    writer.write(":FULLY-SPECIFIED\n:DEGREES\n");
+    const ChannelLayout &layout = clip.getLayout();
+    // Lines go back in the order of the source file, clips made in memory list bones with channels by index
+    std::vector<int> bone_order = clip.getBoneOrder();
+    if (bone_order.empty()) {
+        for (int bone_idx = 0; bone_idx < layout.getBoneNum(); ++bone_idx) {
+            if (layout.getBoneChannelNum(bone_idx) > 0) bone_order.push_back(bone_idx);
+        }
+    }
+    for (int frame = 0; frame < clip.getFrameNum(); ++frame) {
+        const double *row = clip.getFrameData(frame);
+        writer.write(frame + 1).put('\n');
+        for (const int bone_idx : bone_order) {
+            const int channel_num = layout.getBoneChannelNum(bone_idx);
+            writer.write(skeleton->getBonePointer(bone_idx)->name);
+            const int offset = layout.getBoneOffset(bone_idx);
+            for (int channel = offset; channel < offset + channel_num; ++channel) {
+                // Root translation is stored scaled like the skeleton, see AMCParser
+                const bool scaled =
+                    bone_idx == Skeleton::root_idx() && layout.getChannelType(channel) <= ChannelType::TZ;
+                writer.put(' ').write(scaled ? row[channel] / skeleton->getScale() : row[channel]);
             }
+            writer.put('\n');
         }
     }
-    input_stream.close();
-    std::cout << frame_num << " samples in " << file_name.string() << " are read" << std::endl;
+    if (!writer.close()) {
+        std::cerr << "Failed to write " << file_name.string() << std::endl;
+        return false;
+    }
+    std::cout << clip.getFrameNum() << " samples are written to " << file_name.string() << std::endl;
     return true;
 }
-void Motion::render(graphics::Program *program) const { skeleton->render(program); }
+
+unsigned int Motion::getRenderRevision() const { return bone_graphics.getRevision(); }
+
+void Motion::render(graphics::Program *program) const { bone_graphics.render(program); }
 }  // namespace acclaim
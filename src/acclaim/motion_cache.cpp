@@ -0,0 +1,176 @@
+#include "acclaim/motion_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "acclaim/amc_parser.h"
+#include "util/mapped_file.h"
+
+namespace acclaim {
+namespace {
+constexpr std::uint64_t data_alignment = 64;
+constexpr std::uint16_t no_bone_order = 0xFFFF;
+
+struct ChannelEntry final {
+    std::uint16_t bone_idx;
+    std::uint8_t type;
+    std::uint8_t reserved;
+};
+static_assert(sizeof(ChannelEntry) == 4, "ChannelEntry must stay 4 bytes");
+
+std::vector<ChannelEntry> channelTable(const ChannelLayout &layout) {
+    std::vector<ChannelEntry> table(layout.getChannelNum());
+    for (int i = 0; i < layout.getChannelNum(); ++i) {
+        table[i].bone_idx = static_cast<std::uint16_t>(layout.getChannelBone(i));
+        table[i].type = static_cast<std::uint8_t>(layout.getChannelType(i));
+        table[i].reserved = 0;
+    }
+    return table;
+}
+
+// Source line order of the clip's bones, see MotionClip::getBoneOrder
+std::vector<std::uint16_t> boneOrderTable(const MotionClip &clip, const Skeleton &skeleton) {
+    std::vector<std::uint16_t> table(skeleton.getMovableBoneNum(), no_bone_order);
+    const std::vector<int> &bone_order = clip.getBoneOrder();
+    if (bone_order.size() == table.size()) std::copy(bone_order.begin(), bone_order.end(), table.begin());
+    return table;
+}
+
+// Size and modification time of source, so a cache made from an older AMC file is not used
+void sourceStamp(const util::fs::path &source, std::uint64_t &size, std::int64_t &time) {
+    size = 0;
+    time = 0;
+    std::error_code error;
+    if (source.empty() || !util::fs::exists(source, error)) return;
+    size = static_cast<std::uint64_t>(util::fs::file_size(source, error));
+    time = static_cast<std::int64_t>(util::fs::last_write_time(source, error).time_since_epoch().count());
+}
+}  // namespace
+
+util::fs::path motionCachePath(const util::fs::path &amc_file) {
+    util::fs::path cache_file = amc_file;
+    return cache_file.replace_extension(".amcb");
+}
+
+bool writeMotionCache(const util::fs::path &cache_file, const MotionClip &clip, const Skeleton &skeleton,
+                      const util::fs::path &source) {
+    const std::vector<ChannelEntry> table = channelTable(clip.getLayout());
+    const std::vector<std::uint16_t> bone_order = boneOrderTable(clip, skeleton);
+    const std::uint64_t table_end = sizeof(MotionCacheHeader) + table.size() * sizeof(ChannelEntry) +
+                                    bone_order.size() * sizeof(std::uint16_t);
+
+    MotionCacheHeader header;
+    std::memcpy(header.magic, MotionCacheHeader::magic_value, sizeof(header.magic));
+    header.version = MotionCacheHeader::current_version;
+    header.byte_order = MotionCacheHeader::byte_order_value;
+    header.channel_num = static_cast<std::uint32_t>(clip.getChannelNum());
+    header.skeleton_fingerprint = skeleton.getFingerprint();
+    header.frame_num = static_cast<std::uint64_t>(clip.getFrameNum());
+    header.frame_rate = clip.getFrameRate();
+    header.data_offset = (table_end + data_alignment - 1) / data_alignment * data_alignment;
+    sourceStamp(source, header.source_size, header.source_time);
+
+    // Write next to the target and rename, so a reader never maps a half written file
+    util::fs::path temp_file = cache_file;
+    temp_file += ".tmp";
+    {
+        std::ofstream output_stream(temp_file, std::ios::binary | std::ios::trunc);
+        if (!output_stream) {
+            std::cerr << "Failed to create " << temp_file << std::endl;
+            return false;
+        }
+        const std::vector<char> padding(header.data_offset - table_end, 0);
+        output_stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        output_stream.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(ChannelEntry));
+        output_stream.write(reinterpret_cast<const char *>(bone_order.data()),
+                            bone_order.size() * sizeof(std::uint16_t));
+        output_stream.write(padding.data(), padding.size());
+        if (clip.getFrameNum() > 0) {
+            output_stream.write(reinterpret_cast<const char *>(clip.getFrameData(0)),
+                                header.frame_num * header.channel_num * sizeof(double));
+        }
+        if (!output_stream) {
+            std::cerr << "Failed to write " << temp_file << std::endl;
+            output_stream.close();
+            std::error_code error;
+            util::fs::remove(temp_file, error);
+            return false;
+        }
+    }
+    std::error_code error;
+    util::fs::rename(temp_file, cache_file, error);
+    if (error) {
+        std::cerr << "Failed to write " << cache_file << ": " << error.message() << std::endl;
+        util::fs::remove(temp_file, error);
+        return false;
+    }
+    return true;
+}
+
+bool readMotionCache(const util::fs::path &cache_file, const Skeleton &skeleton, MotionClip &clip,
+                     const util::fs::path &source) {
+    std::error_code error;
+    if (!util::fs::exists(cache_file, error)) return false;
+    auto file = std::make_shared<util::MappedFile>();
+    if (!file->open(cache_file)) return false;
+
+    MotionCacheHeader header;
+    if (file->size() < sizeof(header)) return false;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, MotionCacheHeader::magic_value, sizeof(header.magic)) != 0 ||
+        header.version != MotionCacheHeader::current_version ||
+        header.byte_order != MotionCacheHeader::byte_order_value) {
+        return false;
+    }
+    if (header.skeleton_fingerprint != skeleton.getFingerprint()) return false;
+    std::uint64_t source_size;
+    std::int64_t source_time;
+    sourceStamp(source, source_size, source_time);
+    if (source_size != header.source_size || source_time != header.source_time) return false;
+    // Everything must fit in the file before anything is dereferenced
+    const ChannelLayout layout(skeleton);
+    const std::vector<ChannelEntry> table = channelTable(layout);
+    const std::uint64_t table_size = table.size() * sizeof(ChannelEntry);
+    std::vector<std::uint16_t> bone_order_table(skeleton.getMovableBoneNum());
+    const std::uint64_t bone_order_size = bone_order_table.size() * sizeof(std::uint16_t);
+    if (header.channel_num != table.size() || header.data_offset % data_alignment != 0 ||
+        header.data_offset < sizeof(header) + table_size + bone_order_size ||
+        file->size() != header.data_offset + header.frame_num * header.channel_num * sizeof(double)) {
+        return false;
+    }
+    if (table_size != 0 && std::memcmp(file->data() + sizeof(header), table.data(), table_size) != 0) return false;
+    std::memcpy(bone_order_table.data(), file->data() + sizeof(header) + table_size, bone_order_size);
+    std::vector<int> bone_order;
+    if (!bone_order_table.empty() && bone_order_table[0] != no_bone_order) {
+        for (const std::uint16_t bone_idx : bone_order_table) {
+            if (bone_idx >= skeleton.getBoneNum()) return false;
+            bone_order.push_back(bone_idx);
+        }
+    }
+
+    clip = MotionClip(layout);
+    clip.setFrameRate(header.frame_rate);
+    clip.setBoneOrder(std::move(bone_order));
+    clip.attach(file, reinterpret_cast<const double *>(file->data() + header.data_offset),
+                static_cast<int>(header.frame_num));
+    return true;
+}
+
+bool loadMotionClip(const util::fs::path &amc_file, const Skeleton &skeleton, MotionClip &clip) {
+    const util::fs::path cache_file = motionCachePath(amc_file);
+    if (readMotionCache(cache_file, skeleton, clip, amc_file)) {
+        std::cout << clip.getFrameNum() << " samples in " << cache_file.string() << " are read" << std::endl;
+        return true;
+    }
+    if (!readAMCFile(amc_file, skeleton, clip)) return false;
+    // A missing cache only costs the next load a parse, so failing to write one is not an error
+    writeMotionCache(cache_file, clip, skeleton, amc_file);
+    return true;
+}
+}  // namespace acclaim
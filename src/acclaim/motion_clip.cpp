@@ -0,0 +1,152 @@
+#include "acclaim/motion_clip.h"
+
+#include <utility>
+
+namespace acclaim {
+PostureView::PostureView(const ChannelLayout *_layout, const double *_row) noexcept : layout(_layout), row(_row) {}
+
+Eigen::Vector4d PostureView::getRotation(const int bone_idx) const {
+    Eigen::Vector4d rotation = Eigen::Vector4d::Zero();
+    for (int k = 0; k < 3; ++k) {
+        const int channel = layout->getChannelIndex(bone_idx, static_cast<ChannelType>(k + 3));
+        if (channel >= 0) rotation[k] = row[channel];
+    }
+    return rotation;
+}
+
+Eigen::Vector4d PostureView::getTranslation(const int bone_idx) const {
+    Eigen::Vector4d translation = Eigen::Vector4d::Zero();
+    for (int k = 0; k < 3; ++k) {
+        const int channel = layout->getChannelIndex(bone_idx, static_cast<ChannelType>(k));
+        if (channel >= 0) translation[k] = row[channel];
+    }
+    return translation;
+}
+
+double PostureView::getChannel(const int channel) const { return row[channel]; }
+
+const double *PostureView::data() const { return row; }
+
+void PostureView::toPosture(Posture &posture) const { layout->unpack(row, posture); }
+
+MotionClip::MotionClip() noexcept {}
+
+MotionClip::MotionClip(const ChannelLayout &_layout) noexcept : layout(_layout) {}
+
+MotionClip::MotionClip(const MotionClip &other) noexcept
+    : layout(other.layout),
+      channels(other.channels),
+      frame_rate(other.frame_rate),
+      bone_order(other.bone_order),
+      mapping(other.mapping),
+      mapped_channels(other.mapped_channels),
+      mapped_frame_num(other.mapped_frame_num) {}
+
+MotionClip::MotionClip(MotionClip &&other) noexcept
+    : layout(std::move(other.layout)),
+      channels(std::move(other.channels)),
+      frame_rate(other.frame_rate),
+      bone_order(std::move(other.bone_order)),
+      mapping(std::move(other.mapping)),
+      mapped_channels(std::exchange(other.mapped_channels, nullptr)),
+      mapped_frame_num(std::exchange(other.mapped_frame_num, 0)) {}
+
+MotionClip &MotionClip::operator=(const MotionClip &other) noexcept {
+    if (this != &other) {
+        layout = other.layout;
+        channels = other.channels;
+        frame_rate = other.frame_rate;
+        bone_order = other.bone_order;
+        mapping = other.mapping;
+        mapped_channels = other.mapped_channels;
+        mapped_frame_num = other.mapped_frame_num;
+    }
+    return *this;
+}
+
+MotionClip &MotionClip::operator=(MotionClip &&other) noexcept {
+    if (this != &other) {
+        layout = std::move(other.layout);
+        channels = std::move(other.channels);
+        frame_rate = other.frame_rate;
+        bone_order = std::move(other.bone_order);
+        mapping = std::move(other.mapping);
+        mapped_channels = std::exchange(other.mapped_channels, nullptr);
+        mapped_frame_num = std::exchange(other.mapped_frame_num, 0);
+    }
+    return *this;
+}
+
+const ChannelLayout &MotionClip::getLayout() const { return layout; }
+
+int MotionClip::getFrameNum() const {
+    if (mapping) return mapped_frame_num;
+    const int channel_num = layout.getChannelNum();
+    return channel_num == 0 ? 0 : static_cast<int>(channels.size()) / channel_num;
+}
+
+int MotionClip::getChannelNum() const { return layout.getChannelNum(); }
+
+double MotionClip::getFrameRate() const { return frame_rate; }
+
+void MotionClip::setFrameRate(const double _frame_rate) { frame_rate = _frame_rate; }
+
+bool MotionClip::isMapped() const { return mapping != nullptr; }
+
+const std::vector<int> &MotionClip::getBoneOrder() const { return bone_order; }
+
+void MotionClip::setBoneOrder(std::vector<int> _bone_order) { bone_order = std::move(_bone_order); }
+
+PostureView MotionClip::getPosture(const int frame_idx) const {
+    return PostureView(&layout, getFrameData(frame_idx));
+}
+
+double *MotionClip::getFrameData(const int frame_idx) {
+    detach();
+    return channels.data() + static_cast<std::size_t>(frame_idx) * layout.getChannelNum();
+}
+
+const double *MotionClip::getFrameData(const int frame_idx) const {
+    const double *data = mapping ? mapped_channels : channels.data();
+    return data + static_cast<std::size_t>(frame_idx) * layout.getChannelNum();
+}
+
+void MotionClip::setPosture(const int frame_idx, const Posture &posture) {
+    layout.pack(posture, getFrameData(frame_idx));
+}
+
+double *MotionClip::appendFrame() {
+    detach();
+    channels.resize(channels.size() + layout.getChannelNum(), 0.0);
+    return getFrameData(getFrameNum() - 1);
+}
+
+void MotionClip::reserve(const int frame_num) {
+    detach();
+    channels.reserve(static_cast<std::size_t>(frame_num) * layout.getChannelNum());
+}
+
+void MotionClip::resize(const int frame_num) {
+    detach();
+    channels.resize(static_cast<std::size_t>(frame_num) * layout.getChannelNum(), 0.0);
+}
+
+void MotionClip::shrinkToFit() { channels.shrink_to_fit(); }
+
+void MotionClip::attach(const std::shared_ptr<const util::MappedFile> &file, const double *data,
+                        const int frame_num) {
+    channels.clear();
+    channels.shrink_to_fit();
+    mapping = file;
+    mapped_channels = data;
+    mapped_frame_num = frame_num;
+}
+
+void MotionClip::detach() {
+    if (!mapping) return;
+    channels.assign(mapped_channels, mapped_channels + static_cast<std::size_t>(mapped_frame_num) * getChannelNum());
+    mapping.reset();
+    mapped_channels = nullptr;
+    mapped_frame_num = 0;
+}
+}  // namespace acclaim
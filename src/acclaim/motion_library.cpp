@@ -0,0 +1,123 @@
+#include "acclaim/motion_library.h"
+
+#include <algorithm>
+#include <iostream>
+#include <system_error>
+#include <utility>
+
+#include "acclaim/motion_cache.h"
+
+namespace acclaim {
+namespace {
+std::size_t clipSize(const MotionClip &clip) {
+    return static_cast<std::size_t>(clip.getFrameNum()) * clip.getChannelNum() * sizeof(double);
+}
+}  // namespace
+
+MotionLibrary::MotionLibrary(std::shared_ptr<const Skeleton> _skeleton, std::size_t _memory_budget) noexcept
+    : skeleton(std::move(_skeleton)), memory_budget(_memory_budget) {}
+
+MotionLibrary::MotionLibrary(const MotionLibrary &other) noexcept
+    : skeleton(other.skeleton),
+      memory_budget(other.memory_budget),
+      resident_size(other.resident_size),
+      entries(other.entries),
+      lru(other.lru) {
+    // Iterators still point into other's list
+    for (auto it = lru.begin(); it != lru.end(); ++it) entries[*it].lru_position = it;
+}
+
+MotionLibrary::MotionLibrary(MotionLibrary &&other) noexcept
+    : skeleton(std::move(other.skeleton)),
+      memory_budget(other.memory_budget),
+      resident_size(std::exchange(other.resident_size, 0)),
+      entries(std::move(other.entries)),
+      lru(std::move(other.lru)) {}
+
+MotionLibrary &MotionLibrary::operator=(const MotionLibrary &other) noexcept {
+    if (this != &other) {
+        skeleton = other.skeleton;
+        memory_budget = other.memory_budget;
+        resident_size = other.resident_size;
+        entries = other.entries;
+        lru = other.lru;
+        for (auto it = lru.begin(); it != lru.end(); ++it) entries[*it].lru_position = it;
+    }
+    return *this;
+}
+
+MotionLibrary &MotionLibrary::operator=(MotionLibrary &&other) noexcept {
+    if (this != &other) {
+        skeleton = std::move(other.skeleton);
+        memory_budget = other.memory_budget;
+        resident_size = std::exchange(other.resident_size, 0);
+        entries = std::move(other.entries);
+        lru = std::move(other.lru);
+    }
+    return *this;
+}
+
+const std::shared_ptr<const Skeleton> &MotionLibrary::getSkeleton() const { return skeleton; }
+
+int MotionLibrary::addClip(const util::fs::path &amc_file) {
+    entries.emplace_back().file_name = amc_file;
+    return static_cast<int>(entries.size()) - 1;
+}
+
+int MotionLibrary::addFolder(const util::fs::path &folder) {
+    std::error_code error;
+    std::vector<util::fs::path> files;
+    for (const auto &entry : util::fs::directory_iterator(folder, error)) {
+        if (entry.is_regular_file(error) && entry.path().extension() == ".amc") files.push_back(entry.path());
+    }
+    if (error) std::cerr << "Failed to list " << folder << ": " << error.message() << std::endl;
+    // Directory order is unspecified, sort so clip indices are stable
+    std::sort(files.begin(), files.end());
+    for (const util::fs::path &file : files) addClip(file);
+    return static_cast<int>(files.size());
+}
+
+int MotionLibrary::getClipNum() const { return static_cast<int>(entries.size()); }
+
+const util::fs::path &MotionLibrary::getClipPath(const int clip_idx) const { return entries[clip_idx].file_name; }
+
+std::shared_ptr<const MotionClip> MotionLibrary::getClip(const int clip_idx) {
+    Entry &entry = entries[clip_idx];
+    if (entry.clip) {
+        lru.splice(lru.begin(), lru, entry.lru_position);
+        return entry.clip;
+    }
+    auto clip = std::make_shared<MotionClip>(ChannelLayout(*skeleton));
+    if (!loadMotionClip(entry.file_name, *skeleton, *clip)) return nullptr;
+    clip->shrinkToFit();
+    entry.clip = std::move(clip);
+    entry.size = clipSize(*entry.clip);
+    resident_size += entry.size;
+    lru.push_front(clip_idx);
+    entry.lru_position = lru.begin();
+    evict(clip_idx);
+    return entry.clip;
+}
+
+bool MotionLibrary::isResident(const int clip_idx) const { return entries[clip_idx].clip != nullptr; }
+
+std::size_t MotionLibrary::getResidentSize() const { return resident_size; }
+
+std::size_t MotionLibrary::getMemoryBudget() const { return memory_budget; }
+
+void MotionLibrary::setMemoryBudget(const std::size_t _memory_budget) {
+    memory_budget = _memory_budget;
+    evict(-1);
+}
+
+void MotionLibrary::evict(const int keep_idx) {
+    while (resident_size > memory_budget && !lru.empty() && lru.back() != keep_idx) {
+        Entry &entry = entries[lru.back()];
+        // Callers holding the clip keep it alive, the library only drops its reference
+        entry.clip.reset();
+        resident_size -= entry.size;
+        entry.size = 0;
+        lru.pop_back();
+    }
+}
+}  // namespace acclaim
@@ -0,0 +1,121 @@
+#include "acclaim/motion_stream.h"
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+
+namespace acclaim {
+MotionStream::MotionStream(const Skeleton &_skeleton, int _window) noexcept
+    : skeleton(&_skeleton), layout(_skeleton), window(std::max(_window, 1)) {}
+
+MotionStream::~MotionStream() { close(); }
+
+bool MotionStream::open(const util::fs::path &amc_file) {
+    close();
+    if (!file.open(amc_file)) return false;
+    name = amc_file.string();
+    frame_num = indexAMCFrames(file.data(), file.data() + file.size(), index_stride, index);
+    ring.assign(static_cast<std::size_t>(window) * layout.getChannelNum(), 0.0);
+    window_begin = decoded_begin = decoded_end = 0;
+    failed_frame = frame_num;
+    stopping = false;
+    if (frame_num > 0) worker = std::thread(&MotionStream::readAhead, this);
+    std::cout << frame_num << " samples in " << name << " are indexed" << std::endl;
+    return true;
+}
+
+void MotionStream::close() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        window_moved.notify_all();
+        worker.join();
+    }
+    file.close();
+    frame_num = 0;
+    index.clear();
+    ring.clear();
+}
+
+bool MotionStream::isOpen() const { return file.isOpen(); }
+
+const ChannelLayout &MotionStream::getLayout() const { return layout; }
+
+int MotionStream::getFrameNum() const { return frame_num; }
+
+bool MotionStream::getFrameData(int frame_idx, double *row) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const double *frame = waitFrame(frame_idx, lock);
+    if (frame == nullptr) return false;
+    std::copy_n(frame, layout.getChannelNum(), row);
+    return true;
+}
+
+bool MotionStream::getPosture(int frame_idx, Posture &posture) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const double *frame = waitFrame(frame_idx, lock);
+    if (frame == nullptr) return false;
+    layout.unpack(frame, posture);
+    return true;
+}
+
+const double *MotionStream::waitFrame(int frame_idx, std::unique_lock<std::mutex> &lock) {
+    if (frame_idx < 0 || frame_idx >= frame_num) return nullptr;
+    if (frame_idx < decoded_begin || frame_idx >= decoded_end + index_stride) {
+        // Decoding forward to frame_idx would take longer than restarting from the index
+        decoded_begin = decoded_end = frame_idx;
+        failed_frame = frame_num;
+        ++seek_count;
+    }
+    window_begin = frame_idx;
+    window_moved.notify_one();
+    frame_decoded.wait(lock, [&] { return frame_idx < decoded_end || frame_idx >= failed_frame; });
+    if (frame_idx >= decoded_end) return nullptr;
+    return ring.data() + static_cast<std::size_t>(frame_idx % window) * layout.getChannelNum();
+}
+
+void MotionStream::readAhead() {
+    // Frames between an index entry and the seek target are decoded here and dropped
+    std::vector<double> skipped(layout.getChannelNum());
+    std::optional<AMCParser> parser;
+    int parser_seek = -1;
+    int next_frame = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        window_moved.wait(lock, [&] {
+            return stopping || parser_seek != seek_count ||
+                   decoded_end < std::min(window_begin + window, failed_frame);
+        });
+        if (stopping) return;
+        if (parser_seek != seek_count) {
+            const AMCFrameOffset &entry = index[decoded_end / index_stride];
+            parser.emplace(*skeleton, layout, entry.position, file.data() + file.size(), name, entry.line);
+            next_frame = decoded_end / index_stride * index_stride;
+            parser_seek = seek_count;
+            continue;
+        }
+        const int seek = seek_count;
+        const int frame = next_frame++;
+        double *row = skipped.data();
+        if (frame == decoded_end) {
+            // The oldest frame leaves the ring before its row is overwritten
+            decoded_begin = std::max(decoded_begin, frame + 1 - window);
+            row = ring.data() + static_cast<std::size_t>(frame % window) * layout.getChannelNum();
+        }
+        lock.unlock();
+        const bool success = parser->readFrame(row);
+        lock.lock();
+        // A seek while decoding invalidates the frame, the parser is moved on the next iteration
+        if (seek != seek_count) continue;
+        if (!success) {
+            failed_frame = frame;
+            frame_decoded.notify_all();
+        } else if (frame == decoded_end) {
+            ++decoded_end;
+            frame_decoded.notify_all();
+        }
+    }
+}
+}  // namespace acclaim
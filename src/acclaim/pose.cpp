@@ -0,0 +1,39 @@
+#include "acclaim/pose.h"
+
+#include <utility>
+
+namespace acclaim {
+Pose::Pose() noexcept {}
+
+Pose::Pose(const std::size_t size) noexcept
+    : transforms(size, util::RigidTransform::Identity()),
+      end_positions(size, Eigen::Vector4d::Zero()),
+      local_rotations(size, Eigen::Quaterniond::Identity()) {}
+
+Pose::Pose(const Pose &other) noexcept
+    : transforms(other.transforms),
+      end_positions(other.end_positions),
+      local_rotations(other.local_rotations) {}
+
+Pose::Pose(Pose &&other) noexcept
+    : transforms(std::move(other.transforms)),
+      end_positions(std::move(other.end_positions)),
+      local_rotations(std::move(other.local_rotations)) {}
+
+Pose &Pose::operator=(const Pose &other) noexcept {
+    if (this != &other) {
+        transforms = other.transforms;
+        end_positions = other.end_positions;
+        local_rotations = other.local_rotations;
+    }
+    return *this;
+}
+Pose &Pose::operator=(Pose &&other) noexcept {
+    if (this != &other) {
+        transforms = std::move(other.transforms);
+        end_positions = std::move(other.end_positions);
+        local_rotations = std::move(other.local_rotations);
+    }
+    return *this;
+}
+}  // namespace acclaim
@@ -1,13 +1,46 @@
 #include "acclaim/skeleton.h"
 
-#include <fstream>
+#include <charconv>
 #include <iostream>
-#include <sstream>
 #include <utility>
 
 #include "util/helper.h"
+#include "util/mapped_file.h"
+#include "util/text_writer.h"
+#include "util/tokenizer.h"
 
 namespace acclaim {
+namespace {
+// 64-bit FNV-1a
+constexpr std::uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+constexpr std::uint64_t fnvPrime = 1099511628211ULL;
+std::uint64_t hashBytes(std::uint64_t hash, const void *data, std::size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * fnvPrime;
+    }
+    return hash;
+}
+template <typename T>
+std::uint64_t hashValue(std::uint64_t hash, const T &value) {
+    return hashBytes(hash, &value, sizeof(T));
+}
+// Read the next number of a limits line. Limits are written as "(-160.0 20.0)", so parentheses around the
+// numbers are skipped, either attached or as separate tokens. Unbounded limits are written as inf
+bool readLimit(util::Tokenizer &tokenizer, double &value) {
+    std::string_view token = tokenizer.next();
+    while (token == "(" || token == ")") token = tokenizer.next();
+    if (!token.empty() && token.front() == '(') token.remove_prefix(1);
+    if (!token.empty() && token.back() == ')') token.remove_suffix(1);
+    if (!token.empty() && token.front() == '+') token.remove_prefix(1);
+    const auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (token.empty() || ec != std::errc() || ptr != token.data() + token.size()) {
+        tokenizer.error("expected a limit but got \"" + std::string(token) + "\"");
+        return false;
+    }
+    return true;
+}
+}  // namespace
 
 Skeleton::Skeleton(const util::fs::path &file_name, const double _scale) noexcept : scale(_scale) {
     bones.reserve(64);
@@ -28,15 +61,29 @@ Skeleton::Skeleton(const util::fs::path &file_name, const double _scale) noexcep
     bones[0].dofty = true;
     bones[0].doftz = true;
     // build hierarchy and read in each bone's DOF information
-    readASFFile(file_name);
+    loaded = readASFFile(file_name);
+    if (!loaded) {
+        std::cerr << "Error in reading ASF file, this skeleton is incomplete!" << std::endl;
+    }
+    computeFingerprint();
     computeLocalDirection();
     computeLocalRotation();
-
-    setBoneGraphics();
+    computeGlobalFacing();
 }
 
 Skeleton::Skeleton(const Skeleton &other) noexcept
-    : scale(other.scale), movableBones(other.movableBones), bones(other.bones), bone_graphics(other.bone_graphics) {
+    : scale(other.scale),
+      loaded(other.loaded),
+      movableBones(other.movableBones),
+      fingerprint(other.fingerprint),
+      bones(other.bones),
+      bone_facings(other.bone_facings),
+      bone_normal_facings(other.bone_normal_facings),
+      bone_indices(other.bone_indices),
+      units(other.units),
+      root_order(other.root_order),
+      root_axis(other.root_axis),
+      root_position(other.root_position) {
     for (std::size_t i = 0; i < bones.size(); ++i) {
         if (bones[i].parent != nullptr) {
             bones[i].parent = &bones[other.bones[i].parent->idx];
@@ -52,15 +99,32 @@ Skeleton::Skeleton(const Skeleton &other) noexcept
 
 Skeleton::Skeleton(Skeleton &&other) noexcept
     : scale(other.scale),
+      loaded(other.loaded),
       movableBones(other.movableBones),
+      fingerprint(other.fingerprint),
       bones(std::move(other.bones)),
-      bone_graphics(std::move(other.bone_graphics)) {}
+      bone_facings(std::move(other.bone_facings)),
+      bone_normal_facings(std::move(other.bone_normal_facings)),
+      bone_indices(std::move(other.bone_indices)),
+      units(std::move(other.units)),
+      root_order(std::move(other.root_order)),
+      root_axis(std::move(other.root_axis)),
+      root_position(other.root_position) {}
 
 Skeleton &Skeleton::operator=(const Skeleton &other) noexcept {
     if (this != &other) {
         scale = other.scale;
+        loaded = other.loaded;
         movableBones = other.movableBones;
+        fingerprint = other.fingerprint;
         bones = other.bones;
+        bone_facings = other.bone_facings;
+        bone_normal_facings = other.bone_normal_facings;
+        bone_indices = other.bone_indices;
+        units = other.units;
+        root_order = other.root_order;
+        root_axis = other.root_axis;
+        root_position = other.root_position;
         // We need to reset all pointer in bones
         for (std::size_t i = 0; i < bones.size(); ++i) {
             if (bones[i].parent != nullptr) {
@@ -73,7 +137,6 @@ Skeleton &Skeleton::operator=(const Skeleton &other) noexcept {
                 bones[i].sibling = &bones[other.bones[i].sibling->idx];
             }
         }
-        bone_graphics = other.bone_graphics;
     }
     return *this;
 }
@@ -81,71 +144,103 @@ Skeleton &Skeleton::operator=(const Skeleton &other) noexcept {
 Skeleton &Skeleton::operator=(Skeleton &&other) noexcept {
     if (this != &other) {
         scale = other.scale;
+        loaded = other.loaded;
         movableBones = other.movableBones;
+        fingerprint = other.fingerprint;
         bones = std::move(other.bones);
-        bone_graphics = std::move(other.bone_graphics);
+        bone_facings = std::move(other.bone_facings);
+        bone_normal_facings = std::move(other.bone_normal_facings);
+        bone_indices = std::move(other.bone_indices);
+        units = std::move(other.units);
+        root_order = std::move(other.root_order);
+        root_axis = std::move(other.root_axis);
+        root_position = other.root_position;
     }
     return *this;
 }
 
+bool Skeleton::isLoaded() const { return loaded; }
+
 double Skeleton::getScale() const { return scale; }
 
 int Skeleton::getBoneNum() const { return static_cast<int>(bones.size()); }
 
 int Skeleton::getMovableBoneNum() const { return movableBones; }
 
-Bone *Skeleton::getBonePointer(const std::string &name) {
-    for (size_t i = 0; i < bones.size(); ++i) {
-        if (name == bones[i].name) {
-            return &bones[i];
-        }
-    }
-    return nullptr;
-}
+std::uint64_t Skeleton::getFingerprint() const { return fingerprint; }
+
+const std::vector<Eigen::Matrix3d> &Skeleton::getBoneFacings() const { return bone_facings; }
 
-Bone *Skeleton::getBonePointer(const int bone_idx) { return &bones[bone_idx]; }
+const std::vector<Eigen::Matrix3d> &Skeleton::getBoneNormalFacings() const { return bone_normal_facings; }
 
-void Skeleton::setBoneColor(const Eigen::Vector4f &boneColor) const {
-    for (size_t i = 0; i < bones.size(); ++i) bone_graphics[i].setTexture(boneColor);
+const Bone *Skeleton::getBonePointer(const std::string &name) const {
+    auto it = bone_indices.find(name);
+    return it == bone_indices.end() ? nullptr : &bones[it->second];
 }
 
-void Skeleton::setModelMatrices() const {
-    for (size_t i = 0; i < bone_graphics.size(); ++i) {
-        auto &&bone = bones[i];
-        Eigen::Vector4d trans = 0.5 * (bone.start_position + bone.end_position);
-        Eigen::Affine3d model = bone.global_facing;
-        model.prerotate(bone.rotation.rotation()).pretranslate(trans.head<3>());
-        bone_graphics[i].setModelMatrix(model.cast<float>());
-    }
+const Bone *Skeleton::getBonePointer(const int bone_idx) const { return &bones[bone_idx]; }
+
+Bone *Skeleton::findBone(const std::string &name) {
+    auto it = bone_indices.find(name);
+    return it == bone_indices.end() ? nullptr : &bones[it->second];
 }
 
-void Skeleton::render(graphics::Program *program) const {
-    for (size_t i = 0; i < bone_graphics.size(); ++i) {
-        bone_graphics[i].render(program);
+void Skeleton::indexBoneNames() {
+    bone_indices.clear();
+    bone_indices.reserve(bones.size());
+    for (size_t i = 0; i < bones.size(); ++i) {
+        bone_indices.emplace(bones[i].name, static_cast<int>(i));
     }
 }
 
 bool Skeleton::readASFFile(const util::fs::path &file_name) {
-    std::ifstream input_stream(file_name);
-    if (!input_stream) {
-        std::cerr << "Failed to open " << file_name << std::endl;
-        return false;
-    }
-    // ignore header information
-    std::string str, keyword;
+    util::MappedFile file;
+    if (!file.open(file_name)) return false;
+    util::Tokenizer tokenizer(file.data(), file.data() + file.size(), file_name.string());
+    // Header sections, only :units and :root are kept
+    std::string_view section;
     while (true) {
-        std::getline(input_stream, str);
-        if (str.compare(0, 9, ":bonedata") == 0) {
+        const std::string_view keyword = tokenizer.next();
+        if (keyword.empty()) {
+            tokenizer.error("missing :bonedata");
+            return false;
+        }
+        if (keyword == ":bonedata") {
             break;
         }
+        bool valid = true;
+        if (keyword.front() == ':') {
+            section = keyword;
+            if (section == ":units") units.clear();
+        } else if (section == ":units") {
+            units.emplace_back(keyword, tokenizer.nextInLine());
+        } else if (section == ":root" && keyword == "order") {
+            root_order.clear();
+            for (std::string_view token = tokenizer.nextInLine(); !token.empty(); token = tokenizer.nextInLine()) {
+                if (!root_order.empty()) root_order += ' ';
+                root_order += token;
+            }
+        } else if (section == ":root" && keyword == "axis") {
+            root_axis = std::string(tokenizer.nextInLine());
+        } else if (section == ":root" && keyword == "position") {
+            valid = tokenizer.next(root_position[0]) && tokenizer.next(root_position[1]) &&
+                    tokenizer.next(root_position[2]);
+        } else if (section == ":root" && keyword == "orientation") {
+            valid = tokenizer.next(bones[0].axis[0]) && tokenizer.next(bones[0].axis[1]) &&
+                    tokenizer.next(bones[0].axis[2]);
+        }
+        if (!valid) return false;
+        tokenizer.skipLine();
     }
-    // Ignore begin
-    input_stream.ignore(1024, '\n');
     bool done = false;
     while (!done) {
         auto &&current_bone = bones.emplace_back();
         while (true) {
-            input_stream >> keyword;
+            const std::string_view keyword = tokenizer.next();
+            if (keyword.empty()) {
+                tokenizer.error("missing :hierarchy");
+                return false;
+            }
             if (keyword == "end") {
                 break;
             }
@@ -155,86 +250,145 @@ bool Skeleton::readASFFile(const util::fs::path &file_name) {
                 bones.pop_back();
                 break;
             }
+            bool valid = true;
             // id of bone
             if (keyword == "id") {
-                input_stream >> current_bone.idx;
-                continue;
+                valid = tokenizer.next(current_bone.idx);
             }
             // name of the bone
             if (keyword == "name") {
-                input_stream >> current_bone.name;
-                continue;
+                current_bone.name = std::string(tokenizer.next());
             }
             // this line describes the bone's direction vector in global coordinate
             // it will later be converted to local coorinate system
             if (keyword == "direction") {
-                input_stream >> current_bone.dir[0] >> current_bone.dir[1] >> current_bone.dir[2];
-                continue;
+                valid = tokenizer.next(current_bone.dir[0]) && tokenizer.next(current_bone.dir[1]) &&
+                        tokenizer.next(current_bone.dir[2]);
+                current_bone.asf_dir = current_bone.dir;
             }
             // length of the bone
             if (keyword == "length") {
-                input_stream >> current_bone.length;
-                current_bone.length *= scale;
-                continue;
+                valid = tokenizer.next(current_bone.asf_length);
+                current_bone.length = current_bone.asf_length * scale;
             }
             // this line describes the orientation of bone's local coordinate
             // system relative to the world coordinate system
             if (keyword == "axis") {
-                input_stream >> current_bone.axis[0] >> current_bone.axis[1] >> current_bone.axis[2];
-                continue;
+                valid = tokenizer.next(current_bone.axis[0]) && tokenizer.next(current_bone.axis[1]) &&
+                        tokenizer.next(current_bone.axis[2]);
             }
             // this line describes the bone's dof
             if (keyword == "dof") {
                 ++movableBones;
-                std::string token;
                 current_bone.dof = 0;
-                std::getline(input_stream, str);
-                std::istringstream iss(str);
-                while (iss >> token) {
-                    if (token.compare(0, 2, "rx") == 0) {
+                for (std::string_view token = tokenizer.nextInLine(); !token.empty();
+                     token = tokenizer.nextInLine()) {
+                    const std::string_view axis = token.substr(0, 2);
+                    if (!current_bone.asf_dof.empty()) current_bone.asf_dof += ' ';
+                    current_bone.asf_dof += axis;
+                    if (axis == "rx") {
                         current_bone.dofrx = true;
                         ++current_bone.dof;
-                    } else if (token.compare(0, 2, "ry") == 0) {
+                    } else if (axis == "ry") {
                         current_bone.dofry = true;
                         ++current_bone.dof;
-                    } else if (token.compare(0, 2, "rz") == 0) {
+                    } else if (axis == "rz") {
                         current_bone.dofrz = true;
                         ++current_bone.dof;
-                    } else if (token.compare(0, 2, "tx") == 0) {
+                    } else if (axis == "tx") {
                         current_bone.doftx = true;
                         ++current_bone.dof;
-                    } else if (token.compare(0, 2, "ty") == 0) {
+                    } else if (axis == "ty") {
                         current_bone.dofty = true;
                         ++current_bone.dof;
-                    } else if (token.compare(0, 2, "tz") == 0) {
+                    } else if (axis == "tz") {
                         current_bone.doftz = true;
                         ++current_bone.dof;
                     } else {
-                        std::cerr << "Unknown token: " << token << std::endl;
+                        tokenizer.error("unknown dof \"" + std::string(token) + "\"");
+                        valid = false;
                     }
                 }
             }
+            // (min, max) of each DOF in the order of the dof line
+            if (keyword == "limits") {
+                current_bone.limits.resize(current_bone.dof);
+                for (auto &&[lower, upper] : current_bone.limits) {
+                    valid = valid && readLimit(tokenizer, lower) && readLimit(tokenizer, upper);
+                }
+            }
+            if (!valid) return false;
         }
     }
-    // skip "begin" line
-    input_stream.ignore(1024, '\n');
-    input_stream.ignore(1024, '\n');
+    indexBoneNames();
     // Assign parent/child relationship to the bones
     while (true) {
-        // read next line
-        std::getline(input_stream, str);
-        std::istringstream iss(str);
-        iss >> keyword;
+        const std::string_view keyword = tokenizer.next();
         // check if we are done
         if (keyword == "end") break;
+        if (keyword.empty()) {
+            tokenizer.error("missing end of :hierarchy");
+            return false;
+        }
+        if (keyword == "begin") continue;
         // parse this line, it contains parent followed by children
-        Bone *parent = this->getBonePointer(keyword);
-        while (iss >> keyword) {
-            this->setBoneHierarchy(parent, getBonePointer(keyword));
+        Bone *parent = this->findBone(std::string(keyword));
+        if (parent == nullptr) {
+            tokenizer.error("unknown bone \"" + std::string(keyword) + "\"");
+            return false;
+        }
+        for (std::string_view child = tokenizer.nextInLine(); !child.empty(); child = tokenizer.nextInLine()) {
+            Bone *child_bone = findBone(std::string(child));
+            if (child_bone == nullptr) {
+                tokenizer.error("unknown bone \"" + std::string(child) + "\"");
+                return false;
+            }
+            this->setBoneHierarchy(parent, child_bone);
         }
     }
     std::cout << bones.size() << " bones in " << file_name.string() << " are read" << std::endl;
-    input_stream.close();
+    return true;
+}
+
+bool Skeleton::writeASFFile(const util::fs::path &file_name) const {
+    util::TextWriter writer;
+    if (!writer.open(file_name)) return false;
+    writer.write(":version 1.10\n:name ").write(file_name.stem().string()).write("\n");
+    writer.write(":units\n");
+    for (const auto &[unit, value] : units) writer.write("  ").write(unit).put(' ').write(value).put('\n');
+    writer.write(":root\n   order ").write(root_order).write("\n   axis ").write(root_axis);
+    writer.write("\n   position ").write(root_position[0]).put(' ').write(root_position[1]).put(' ');
+    writer.write(root_position[2]).write("\n   orientation ").write(bones[0].axis[0]).put(' ');
+    writer.write(bones[0].axis[1]).put(' ').write(bones[0].axis[2]).put('\n');
+    writer.write(":bonedata\n");
+    for (std::size_t i = 1; i < bones.size(); ++i) {
+        const Bone &bone = bones[i];
+        writer.write("  begin\n     id ").write(bone.idx).write("\n     name ").write(bone.name);
+        writer.write("\n     direction ").write(bone.asf_dir[0]).put(' ').write(bone.asf_dir[1]).put(' ');
+        writer.write(bone.asf_dir[2]).write("\n     length ").write(bone.asf_length);
+        writer.write("\n     axis ").write(bone.axis[0]).put(' ').write(bone.axis[1]).put(' ').write(bone.axis[2]);
+        writer.write(" XYZ\n");
+        if (bone.dof > 0) writer.write("    dof ").write(bone.asf_dof).put('\n');
+        for (std::size_t k = 0; k < bone.limits.size(); ++k) {
+            writer.write(k == 0 ? "    limits (" : "           (").write(bone.limits[k].first).put(' ');
+            writer.write(bone.limits[k].second).write(")\n");
+        }
+        writer.write("  end\n");
+    }
+    writer.write(":hierarchy\n  begin\n");
+    for (const Bone &bone : bones) {
+        if (bone.child == nullptr) continue;
+        writer.write("    ").write(bone.name);
+        for (const Bone *child = bone.child; child != nullptr; child = child->sibling) {
+            writer.put(' ').write(child->name);
+        }
+        writer.put('\n');
+    }
+    writer.write("  end\n");
+    if (!writer.close()) {
+        std::cerr << "Failed to write " << file_name.string() << std::endl;
+        return false;
+    }
     return true;
 }
 
@@ -278,10 +432,10 @@ void Skeleton::computeLocalRotation() {
     }
 }
 
-void Skeleton::setBoneGraphics() {
-    bone_graphics.resize(bones.size());
+void Skeleton::computeGlobalFacing() {
+    bone_facings.resize(bones.size());
+    bone_normal_facings.resize(bones.size());
     for (size_t i = 0; i < bones.size(); ++i) {
-        bone_graphics[i].setTexture(Eigen::Vector4f(0.6f, 0.6f, 0.0f, 1.0f));
         auto &&bone = bones[i];
         Eigen::Vector4d rotaion_axis = Eigen::Vector4d::UnitZ().cross3(bone.dir);
         double dot_val = Eigen::Vector4d::UnitZ().dot(bone.dir);
@@ -290,7 +444,27 @@ void Skeleton::setBoneGraphics() {
         double theta = atan2(cross_val, dot_val);
         bone.global_facing = Eigen::AngleAxisd(theta, rotaion_axis.head<3>());
         bone.global_facing.scale(Eigen::Vector3d(1.0, 1.0, bone.length));
+        bone_facings[i] = bone.global_facing.linear();
+        // (R * S)^-T = R * S^-1 for a rotation R and a diagonal S.
+        // A zero length bone is a flat disk, whose normals are simply rotated.
+        const double inverse_length = bone.length == 0.0 ? 1.0 : 1.0 / bone.length;
+        bone_normal_facings[i] = Eigen::AngleAxisd(theta, rotaion_axis.head<3>()).toRotationMatrix() *
+                                 Eigen::Vector3d(1.0, 1.0, inverse_length).asDiagonal();
     }
 }
 
+void Skeleton::computeFingerprint() {
+    std::uint64_t hash = hashValue(fnvOffsetBasis, scale);
+    hash = hashValue(hash, bones.size());
+    for (auto &&bone : bones) {
+        hash = hashBytes(hash, bone.name.data(), bone.name.size());
+        hash = hashValue(hash, bone.parent == nullptr ? -1 : bone.parent->idx);
+        const bool dofs[6] = {bone.dofrx, bone.dofry, bone.dofrz, bone.doftx, bone.dofty, bone.doftz};
+        hash = hashBytes(hash, dofs, sizeof(dofs));
+        hash = hashBytes(hash, bone.dir.data(), 3 * sizeof(double));
+        hash = hashValue(hash, bone.length);
+        hash = hashBytes(hash, bone.axis.data(), 3 * sizeof(double));
+    }
+    fingerprint = hash;
+}
 }  // namespace acclaim
@@ -0,0 +1,255 @@
+#include "acclaim/skin.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+#include "graphics/configs.h"
+#include "simulation/kinematics.h"
+#include "util/mapped_file.h"
+#include "util/tokenizer.h"
+
+namespace acclaim {
+namespace {
+constexpr int tube_sectors = 16;
+// Rings per blend zone at each end of a tube, the middle of a bone is rigid and needs none
+constexpr int blend_rings = 3;
+
+// Start a vertex influenced by bone alone
+graphics::SkinnedVertex makeVertex(const Eigen::Vector3d &position, const Eigen::Vector3d &normal, float u, float v,
+                                   int bone) {
+    graphics::SkinnedVertex vertex{};
+    Eigen::Map<Eigen::Vector3f>(vertex.position) = position.cast<float>();
+    Eigen::Map<Eigen::Vector3f>(vertex.normal) = normal.normalized().cast<float>();
+    vertex.texCoord[0] = u;
+    vertex.texCoord[1] = v;
+    vertex.bones[0] = static_cast<GLubyte>(bone);
+    vertex.weights[0] = 1.0f;
+    return vertex;
+}
+}  // namespace
+
+Skin::Skin() noexcept {}
+
+Skin::Skin(const util::fs::path &skin_file, const Skeleton &skeleton) noexcept {
+    if (!readSkinFile(skin_file, skeleton)) {
+        std::cerr << "Error in reading skin file, this object is not initialized!" << std::endl;
+        std::cerr << "You can call readSkinFile() to initialize again" << std::endl;
+    }
+}
+
+Skin::Skin(const Skeleton &skeleton, double radius) noexcept {
+    if (skeleton.getBoneNum() > graphics::g_MaxSkinBones) {
+        std::cerr << "Skeleton has more than " << graphics::g_MaxSkinBones << " bones and cannot be skinned"
+                  << std::endl;
+        return;
+    }
+    Pose rest_pose;
+    computeInverseRestTransforms(skeleton, rest_pose);
+    generateTubes(skeleton, rest_pose, radius);
+}
+
+Skin::Skin(const Skin &other) noexcept
+    : vertices(other.vertices), indices(other.indices), inverse_rest_transforms(other.inverse_rest_transforms) {}
+
+Skin::Skin(Skin &&other) noexcept
+    : vertices(std::move(other.vertices)),
+      indices(std::move(other.indices)),
+      inverse_rest_transforms(std::move(other.inverse_rest_transforms)) {}
+
+Skin &Skin::operator=(const Skin &other) noexcept {
+    if (this != &other) {
+        vertices = other.vertices;
+        indices = other.indices;
+        inverse_rest_transforms = other.inverse_rest_transforms;
+    }
+    return *this;
+}
+
+Skin &Skin::operator=(Skin &&other) noexcept {
+    if (this != &other) {
+        vertices = std::move(other.vertices);
+        indices = std::move(other.indices);
+        inverse_rest_transforms = std::move(other.inverse_rest_transforms);
+    }
+    return *this;
+}
+
+const std::vector<graphics::SkinnedVertex> &Skin::getVertices() const { return vertices; }
+
+const std::vector<GLuint> &Skin::getIndices() const { return indices; }
+
+void Skin::computePalette(const Pose &pose, std::vector<Eigen::AffineCompact3f> &palette) const {
+    const int bone_num = static_cast<int>(std::min(pose.transforms.size(), inverse_rest_transforms.size()));
+    palette.resize(bone_num);
+    for (int idx = 0; idx < bone_num; ++idx) {
+        palette[idx] = (pose.transforms[idx] * inverse_rest_transforms[idx]).toAffine().cast<float>();
+    }
+}
+
+bool Skin::readSkinFile(const util::fs::path &skin_file, const Skeleton &skeleton) {
+    vertices.clear();
+    indices.clear();
+    inverse_rest_transforms.clear();
+    if (skeleton.getBoneNum() > graphics::g_MaxSkinBones) {
+        std::cerr << "Skeleton has more than " << graphics::g_MaxSkinBones << " bones and cannot be skinned"
+                  << std::endl;
+        return false;
+    }
+    util::MappedFile file;
+    if (!file.open(skin_file)) {
+        std::cerr << "Failed to open " << skin_file << std::endl;
+        return false;
+    }
+    util::Tokenizer tokenizer(file.data(), file.data() + file.size(), skin_file.string());
+    // Any error leaves an empty mesh
+    auto fail = [this, &tokenizer](const std::string &message) {
+        tokenizer.error(message);
+        vertices.clear();
+        indices.clear();
+        inverse_rest_transforms.clear();
+        return false;
+    };
+    int count = 0;
+    if (tokenizer.next() != ":bones") return fail("missing :bones");
+    if (!tokenizer.next(count) || count < 0) return fail("invalid bone count");
+    // File bone order to skeleton bone index
+    std::vector<int> bone_indices(count);
+    for (int &bone_idx : bone_indices) {
+        const std::string name(tokenizer.next());
+        const Bone *bone = skeleton.getBonePointer(name);
+        if (bone == nullptr) return fail("unknown bone \"" + name + "\"");
+        bone_idx = bone->idx;
+    }
+
+    if (tokenizer.next() != ":vertices") return fail("missing :vertices");
+    if (!tokenizer.next(count) || count < 0) return fail("invalid vertex count");
+    vertices.resize(count);
+    const double scale = skeleton.getScale();
+    for (graphics::SkinnedVertex &vertex : vertices) {
+        double values[8];
+        int influences[4];
+        for (double &value : values) {
+            if (!tokenizer.next(value)) return fail("expected vertex attribute");
+        }
+        for (int &influence : influences) {
+            if (!tokenizer.next(influence)) return fail("expected bone index");
+            if (influence < 0 || influence >= static_cast<int>(bone_indices.size())) {
+                return fail("bone index out of range");
+            }
+        }
+        double weights[4];
+        for (double &weight : weights) {
+            if (!tokenizer.next(weight)) return fail("expected bone weight");
+        }
+        const double weight_sum = weights[0] + weights[1] + weights[2] + weights[3];
+        if (!(weight_sum > 0.0)) return fail("bone weights must add up to a positive number");
+        Eigen::Map<Eigen::Vector3f>(vertex.position) = (scale * Eigen::Vector3d(values)).cast<float>();
+        Eigen::Map<Eigen::Vector3f>(vertex.normal) = Eigen::Vector3d(values + 3).normalized().cast<float>();
+        vertex.texCoord[0] = static_cast<GLfloat>(values[6]);
+        vertex.texCoord[1] = static_cast<GLfloat>(values[7]);
+        for (int i = 0; i < 4; ++i) {
+            vertex.bones[i] = static_cast<GLubyte>(bone_indices[influences[i]]);
+            vertex.weights[i] = static_cast<GLfloat>(weights[i] / weight_sum);
+        }
+    }
+
+    if (tokenizer.next() != ":triangles") return fail("missing :triangles");
+    if (!tokenizer.next(count) || count < 0) return fail("invalid triangle count");
+    indices.resize(3 * static_cast<std::size_t>(count));
+    for (GLuint &index : indices) {
+        int vertex_idx = 0;
+        if (!tokenizer.next(vertex_idx)) return fail("expected vertex index");
+        if (vertex_idx < 0 || vertex_idx >= static_cast<int>(vertices.size())) {
+            return fail("vertex index out of range");
+        }
+        index = static_cast<GLuint>(vertex_idx);
+    }
+    Pose rest_pose;
+    computeInverseRestTransforms(skeleton, rest_pose);
+    return true;
+}
+
+void Skin::computeInverseRestTransforms(const Skeleton &skeleton, Pose &rest_pose) {
+    const int bone_num = skeleton.getBoneNum();
+    rest_pose = Pose(bone_num);
+    kinematics::forwardSolver(Posture(bone_num), skeleton.getBonePointer(Skeleton::root_idx()), rest_pose);
+    inverse_rest_transforms.resize(bone_num);
+    for (int idx = 0; idx < bone_num; ++idx) inverse_rest_transforms[idx] = rest_pose.transforms[idx].inverse();
+}
+
+void Skin::generateTubes(const Skeleton &skeleton, const Pose &rest_pose, double radius) {
+    const std::vector<Eigen::Matrix3d> &facings = skeleton.getBoneFacings();
+    const std::vector<Eigen::Matrix3d> &normal_facings = skeleton.getBoneNormalFacings();
+    for (int idx = 0; idx < skeleton.getBoneNum(); ++idx) {
+        const Bone *bone = skeleton.getBonePointer(idx);
+        if (bone->parent == nullptr || bone->length <= 0.0) continue;
+        // Same frame as the bone's cylinder: unit height along local z, centered at the bone's midpoint
+        const Eigen::Matrix3d rotation = rest_pose.transforms[idx].rotation.toRotationMatrix();
+        const Eigen::Matrix3d linear = rotation * facings[idx];
+        const Eigen::Matrix3d normal_linear = rotation * normal_facings[idx];
+        const Eigen::Vector3d center =
+            0.5 * (rest_pose.transforms[idx].translation + rest_pose.end_positions[idx].head<3>());
+        const int parent = bone->parent->idx;
+        // Blending into several children would pull the joint apart, so only a single child is blended
+        const int child = (bone->child != nullptr && bone->child->sibling == nullptr) ? bone->child->idx : -1;
+        const double blend = std::min(2.0 * radius, 0.5 * bone->length);
+        // Distance of every ring from the bone's start
+        std::vector<double> rings;
+        for (int i = 0; i <= blend_rings; ++i) rings.push_back(blend * i / blend_rings);
+        for (int i = blend_rings; i >= 0; --i) rings.push_back(bone->length - blend * i / blend_rings);
+
+        // Side of the tube, joints are shared half and half with the neighbouring bone
+        const GLuint side_begin = static_cast<GLuint>(vertices.size());
+        for (const double distance : rings) {
+            const double z = distance / bone->length - 0.5;
+            const double parent_weight = 0.5 * std::max(0.0, 1.0 - distance / blend);
+            const double child_weight = child < 0 ? 0.0 : 0.5 * std::max(0.0, 1.0 - (bone->length - distance) / blend);
+            for (int sector = 0; sector <= tube_sectors; ++sector) {
+                const double angle = 2.0 * EIGEN_PI * sector / tube_sectors;
+                const Eigen::Vector3d direction(std::cos(angle), std::sin(angle), 0.0);
+                graphics::SkinnedVertex vertex = makeVertex(
+                    linear * Eigen::Vector3d(radius * direction.x(), radius * direction.y(), z) + center,
+                    normal_linear * direction, static_cast<float>(sector) / tube_sectors, static_cast<float>(z + 0.5),
+                    idx);
+                vertex.weights[0] = static_cast<GLfloat>(1.0 - parent_weight - child_weight);
+                vertex.bones[1] = static_cast<GLubyte>(parent);
+                vertex.weights[1] = static_cast<GLfloat>(parent_weight);
+                vertex.bones[2] = static_cast<GLubyte>(child < 0 ? idx : child);
+                vertex.weights[2] = static_cast<GLfloat>(child_weight);
+                vertices.push_back(vertex);
+            }
+        }
+        for (int ring = 0; ring + 1 < static_cast<int>(rings.size()); ++ring) {
+            for (int sector = 0; sector < tube_sectors; ++sector) {
+                const GLuint v00 = side_begin + ring * (tube_sectors + 1) + sector;
+                const GLuint v10 = v00 + tube_sectors + 1;
+                indices.insert(indices.end(), {v00, v00 + 1, v10 + 1, v00, v10 + 1, v10});
+            }
+        }
+        // Flat caps copy the weights of the first and last ring
+        for (const int end : {0, 1}) {
+            const GLuint ring_begin = side_begin + end * (static_cast<GLuint>(rings.size()) - 1) * (tube_sectors + 1);
+            const Eigen::Vector3d axis(0.0, 0.0, end == 0 ? -1.0 : 1.0);
+            const Eigen::Vector3d normal = normal_linear * axis;
+            const GLuint cap_center = static_cast<GLuint>(vertices.size());
+            graphics::SkinnedVertex center_vertex = vertices[ring_begin];
+            Eigen::Map<Eigen::Vector3f>(center_vertex.position) = (linear * (0.5 * axis) + center).cast<float>();
+            vertices.push_back(center_vertex);
+            for (int sector = 0; sector <= tube_sectors; ++sector) vertices.push_back(vertices[ring_begin + sector]);
+            for (GLuint i = cap_center; i < static_cast<GLuint>(vertices.size()); ++i) {
+                Eigen::Map<Eigen::Vector3f>(vertices[i].normal) = normal.normalized().cast<float>();
+            }
+            for (GLuint sector = 0; sector < tube_sectors; ++sector) {
+                const GLuint current = cap_center + 1 + sector;
+                if (end == 0) {
+                    indices.insert(indices.end(), {cap_center, current + 1, current});
+                } else {
+                    indices.insert(indices.end(), {cap_center, current, current + 1});
+                }
+            }
+        }
+    }
+}
+}  // namespace acclaim
@@ -1,5 +1,6 @@
 #include "graphics/cylinder.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "glad/gl.h"
@@ -10,11 +11,8 @@
 
 namespace graphics {
 
-namespace {
-GLsizei nIndices = 0;
-}
-
 bool Cylinder::isInitialized = false;
+std::array<LodRange, g_LodLevels> Cylinder::lods;
 std::weak_ptr<Buffer<1, GL_ARRAY_BUFFER>> Cylinder::vbo_weak;
 std::weak_ptr<Buffer<2, GL_ELEMENT_ARRAY_BUFFER>> Cylinder::ebo_weak;
 
@@ -73,101 +71,107 @@ void Cylinder::bindVBO() const { vbo->bind(); }
 void Cylinder::generateVertices() {
     // http://www.songho.ca/opengl/gl_cylinder.html#cylinderconst
     if (!Cylinder::isInitialized) {
+        // Every level of detail is appended to the same buffers, indices are absolute
         std::vector<GLfloat> vertices;
         std::vector<GLuint> indices;
 
-        vertices.reserve(2 * 8 * (2 * g_CylinderSectors + 1) + 2);
-
-        float sectorStep = static_cast<float>(2.0 * util::PI / g_CylinderSectors);
-        float sectorAngle = 0;  // radian
-        std::vector<float> unitCircle((g_CylinderSectors + 1) * 3);
-
-        std::vector<float> unitCircleVertices;
-        int currentPos = -1;
-        for (int i = 0; i <= g_CylinderSectors; ++i) {
-            unitCircle[++currentPos] = cosf(sectorAngle);  // x
-            unitCircle[++currentPos] = sinf(sectorAngle);  // y
-            unitCircle[++currentPos] = 0;                  // z
-            sectorAngle += sectorStep;
-        }
-        // put side vertices to arrays
-        for (int i = 0; i < 2; ++i) {
-            float h = -g_CylinderHeight / 2.0f + i * g_CylinderHeight;  // z value; -h/2 to h/2
-            float t = 1.0f - i;                                         // vertical tex coord; 1 to 0
-
-            for (int j = 0, k = 0; j <= g_CylinderSectors; ++j, k += 3) {
-                float ux = unitCircle[k];
-                float uy = unitCircle[k + 1];
-                float uz = unitCircle[k + 2];
-                float s = static_cast<float>(j) / g_CylinderSectors;
-                vertices.insert(vertices.end(), {ux * g_CylinderRadius, uy * g_CylinderRadius, h, ux, uy, uz, s, t});
+        for (int level = 0; level < g_LodLevels; ++level) {
+            const int sectors = g_CylinderSectors[level];
+            const int baseIndex = static_cast<int>(vertices.size()) / 8;
+            lods[level].first = static_cast<GLsizei>(indices.size());
+
+            float sectorStep = static_cast<float>(2.0 * util::PI / sectors);
+            float sectorAngle = 0;  // radian
+            std::vector<float> unitCircle((sectors + 1) * 3);
+
+            int currentPos = -1;
+            for (int i = 0; i <= sectors; ++i) {
+                unitCircle[++currentPos] = cosf(sectorAngle);  // x
+                unitCircle[++currentPos] = sinf(sectorAngle);  // y
+                unitCircle[++currentPos] = 0;                  // z
+                sectorAngle += sectorStep;
             }
-        }
-        // the starting index for the base/top surface
-        // NOTE: it is used for generating indices later
-        int baseCenterIndex = static_cast<int>(vertices.size()) / 8;
-        int topCenterIndex = baseCenterIndex + g_CylinderSectors + 1;  // include center vertex
-
-        // put base and top vertices to arrays
-        for (int i = 0; i < 2; ++i) {
-            float h = -g_CylinderHeight / 2.0f + i * g_CylinderHeight;  // z value; -h/2 to h/2
-            float nz = -1.0f + 2.0f * i;                                // z value of normal; -1 to 1
-
-            // center point
-            vertices.insert(vertices.end(), {0, 0, h, 0, 0, nz, 0.5f, 0.5f});
-
-            for (int j = 0, k = 0; j < g_CylinderSectors; ++j, k += 3) {
-                float ux = unitCircle[k];
-                float uy = unitCircle[k + 1];
-                float s = -ux * 0.5f + 0.5f;
-                float t = -uy * 0.5f + 0.5f;
-                vertices.insert(vertices.end(), {ux * g_CylinderRadius, uy * g_CylinderRadius, h, 0, 0, nz, s, t});
+            // put side vertices to arrays
+            for (int i = 0; i < 2; ++i) {
+                float h = -g_CylinderHeight / 2.0f + i * g_CylinderHeight;  // z value; -h/2 to h/2
+                float t = 1.0f - i;                                         // vertical tex coord; 1 to 0
+
+                for (int j = 0, k = 0; j <= sectors; ++j, k += 3) {
+                    float ux = unitCircle[k];
+                    float uy = unitCircle[k + 1];
+                    float uz = unitCircle[k + 2];
+                    float s = static_cast<float>(j) / sectors;
+                    vertices.insert(vertices.end(),
+                                    {ux * g_CylinderRadius, uy * g_CylinderRadius, h, ux, uy, uz, s, t});
+                }
+            }
+            // the starting index for the base/top surface
+            // NOTE: it is used for generating indices later
+            int baseCenterIndex = static_cast<int>(vertices.size()) / 8;
+            int topCenterIndex = baseCenterIndex + sectors + 1;  // include center vertex
+
+            // put base and top vertices to arrays
+            for (int i = 0; i < 2; ++i) {
+                float h = -g_CylinderHeight / 2.0f + i * g_CylinderHeight;  // z value; -h/2 to h/2
+                float nz = -1.0f + 2.0f * i;                                // z value of normal; -1 to 1
+
+                // center point
+                vertices.insert(vertices.end(), {0, 0, h, 0, 0, nz, 0.5f, 0.5f});
+
+                for (int j = 0, k = 0; j < sectors; ++j, k += 3) {
+                    float ux = unitCircle[k];
+                    float uy = unitCircle[k + 1];
+                    float s = -ux * 0.5f + 0.5f;
+                    float t = -uy * 0.5f + 0.5f;
+                    vertices.insert(vertices.end(), {ux * g_CylinderRadius, uy * g_CylinderRadius, h, 0, 0, nz, s, t});
+                }
             }
-        }
 
-        int k1 = 0;                      // 1st vertex index at base
-        int k2 = g_CylinderSectors + 1;  // 1st vertex index at top
-
-        // indices for the side surface
-        for (int i = 0; i < g_CylinderSectors; ++i, ++k1, ++k2) {
-            // 2 triangles per sector
-            // k1 => k1+1 => k2
-            indices.push_back(k1);
-            indices.push_back(k1 + 1);
-            indices.push_back(k2);
-
-            // k2 => k1+1 => k2+1
-            indices.push_back(k2);
-            indices.push_back(k1 + 1);
-            indices.push_back(k2 + 1);
-        }
+            int k1 = baseIndex;                // 1st vertex index at base
+            int k2 = baseIndex + sectors + 1;  // 1st vertex index at top
+
+            // indices for the side surface
+            for (int i = 0; i < sectors; ++i, ++k1, ++k2) {
+                // 2 triangles per sector
+                // k1 => k1+1 => k2
+                indices.push_back(k1);
+                indices.push_back(k1 + 1);
+                indices.push_back(k2);
+
+                // k2 => k1+1 => k2+1
+                indices.push_back(k2);
+                indices.push_back(k1 + 1);
+                indices.push_back(k2 + 1);
+            }
 
-        // indices for the base surface
-        // NOTE: baseCenterIndex and topCenterIndices are pre-computed during vertex generation
-        //      please see the previous code snippet
-        for (int i = 0, k = baseCenterIndex + 1; i < g_CylinderSectors; ++i, ++k) {
-            if (i < g_CylinderSectors - 1) {
-                indices.push_back(baseCenterIndex);
-                indices.push_back(k + 1);
-                indices.push_back(k);
-            } else {
-                indices.push_back(baseCenterIndex);
-                indices.push_back(baseCenterIndex + 1);
-                indices.push_back(k);
+            // indices for the base surface
+            // NOTE: baseCenterIndex and topCenterIndices are pre-computed during vertex generation
+            //      please see the previous code snippet
+            for (int i = 0, k = baseCenterIndex + 1; i < sectors; ++i, ++k) {
+                if (i < sectors - 1) {
+                    indices.push_back(baseCenterIndex);
+                    indices.push_back(k + 1);
+                    indices.push_back(k);
+                } else {
+                    indices.push_back(baseCenterIndex);
+                    indices.push_back(baseCenterIndex + 1);
+                    indices.push_back(k);
+                }
             }
-        }
 
-        // indices for the top surface
-        for (int i = 0, k = topCenterIndex + 1; i < g_CylinderSectors; ++i, ++k) {
-            if (i < g_CylinderSectors - 1) {
-                indices.push_back(topCenterIndex);
-                indices.push_back(k);
-                indices.push_back(k + 1);
-            } else {
-                indices.push_back(topCenterIndex);
-                indices.push_back(k);
-                indices.push_back(topCenterIndex + 1);
+            // indices for the top surface
+            for (int i = 0, k = topCenterIndex + 1; i < sectors; ++i, ++k) {
+                if (i < sectors - 1) {
+                    indices.push_back(topCenterIndex);
+                    indices.push_back(k);
+                    indices.push_back(k + 1);
+                } else {
+                    indices.push_back(topCenterIndex);
+                    indices.push_back(k);
+                    indices.push_back(topCenterIndex + 1);
+                }
             }
+            lods[level].count = static_cast<GLsizei>(indices.size()) - lods[level].first;
         }
         vbo->bind();
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
@@ -175,23 +179,32 @@ void Cylinder::generateVertices() {
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        nIndices = static_cast<GLsizei>(indices.size());
         Cylinder::isInitialized = true;
     }
 }
 
+float Cylinder::boundingRadius(const Eigen::Matrix3f& linear) {
+    // The silhouette error comes from the circular cross section, so only x and y scaling matter
+    return g_CylinderRadius * std::max(linear.col(0).norm(), linear.col(1).norm());
+}
+
 void Cylinder::render(Program* shaderProgram) {
+    const ObjectUniforms& uniforms = shaderProgram->getObjectUniforms();
     if (texture) {
-        shaderProgram->setUniform("useTexture", 1);
-        shaderProgram->setUniform("diffuseTexture", texture->getIndex());
+        shaderProgram->setUniform(uniforms.useTexture, 1);
+        shaderProgram->setUniform(uniforms.diffuseTexture, texture->getIndex());
     } else {
-        shaderProgram->setUniform("useTexture", 0);
-        shaderProgram->setUniform("baseColor", baseColor);
+        shaderProgram->setUniform(uniforms.useTexture, 0);
+        shaderProgram->setUniform(uniforms.baseColor, baseColor);
     }
-    shaderProgram->setUniform("model", modelMatrix);
-    shaderProgram->setUniform("invtransmodel", inverseTransposeModel);
+    shaderProgram->setUniform(uniforms.model, modelMatrix);
+    shaderProgram->setUniform(uniforms.invtransmodel, inverseTransposeModel);
+    const int level = LevelOfDetail::select(
+        g_CylinderSectors,
+        LevelOfDetail::projectedRadius(modelMatrix.translation(), boundingRadius(modelMatrix.linear())));
     glBindVertexArray(vao);
-    glDrawElements(GL_TRIANGLES, nIndices, GL_UNSIGNED_INT, nullptr);
+    glDrawElements(GL_TRIANGLES, lods[level].count, GL_UNSIGNED_INT,
+                   reinterpret_cast<void*>(lods[level].first * sizeof(GLuint)));
     glBindVertexArray(0);
 }
 }  // namespace graphics
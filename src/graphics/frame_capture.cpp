@@ -0,0 +1,134 @@
+#include "graphics/frame_capture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "util/png_writer.h"
+
+namespace graphics {
+namespace {
+// Images waiting for an encoder, capture blocks beyond this instead of growing without bound
+constexpr std::size_t max_queued = 8;
+}  // namespace
+
+FrameCapture::FrameCapture(const util::fs::path& _folder, int latency) noexcept
+    : folder(_folder), ring(std::max(latency, 1)) {
+    std::error_code error;
+    util::fs::create_directories(folder, error);
+    if (error) std::cerr << "Failed to create " << folder << ": " << error.message() << std::endl;
+    for (Readback& readback : ring) glGenBuffers(1, &readback.pbo);
+    // Leave one core to the render thread
+    const unsigned thread_num = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+    for (unsigned i = 0; i < thread_num; ++i) workers.emplace_back(&FrameCapture::encode, this);
+}
+
+FrameCapture::~FrameCapture() {
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    image_queued.notify_all();
+    for (std::thread& worker : workers) worker.join();
+    for (Readback& readback : ring) glDeleteBuffers(1, &readback.pbo);
+}
+
+void FrameCapture::capture(GLuint framebuffer, int width, int height) {
+    Readback& readback = ring[frame_count % ring.size()];
+    if (readback.fence != nullptr) retire(readback);
+    const GLsizeiptr size = 4 * static_cast<GLsizeiptr>(width) * height;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    if (readback.width != width || readback.height != height) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+    // RGBA rows are always 4 byte aligned, the format most drivers copy without conversion
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.width = width;
+    readback.height = height;
+    readback.frame = frame_count++;
+}
+
+void FrameCapture::finish() {
+    // Oldest readback first, so frames are queued in order
+    for (int i = 0; i < static_cast<int>(ring.size()); ++i) {
+        Readback& readback = ring[(frame_count + i) % ring.size()];
+        if (readback.fence != nullptr) retire(readback);
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    image_done.wait(lock, [this] { return queue.empty() && encoding == 0; });
+}
+
+int FrameCapture::getFrameCount() const { return frame_count; }
+
+void FrameCapture::retire(Readback& readback) {
+    // Normally signaled frames ago, so this does not wait
+    glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+    Image image;
+    image.width = readback.width;
+    image.height = readback.height;
+    image.frame = readback.frame;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        image_done.wait(lock, [this] { return queue.size() < max_queued; });
+        if (!spare.empty()) {
+            image.pixels = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+    const std::size_t size = 4 * static_cast<std::size_t>(image.width) * image.height;
+    image.pixels.resize(size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+    if (mapped != nullptr) {
+        std::memcpy(image.pixels.data(), mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (mapped == nullptr) {
+        std::cerr << "Failed to map the readback of frame " << image.frame << std::endl;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(image));
+    }
+    image_queued.notify_one();
+}
+
+void FrameCapture::encode() {
+    std::vector<unsigned char> rgb;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        image_queued.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) return;
+        Image image = std::move(queue.front());
+        queue.pop_front();
+        ++encoding;
+        lock.unlock();
+        image_done.notify_all();
+        // OpenGL reads bottom to top, and the alpha of the color buffer is not meaningful
+        const int width = image.width, height = image.height;
+        rgb.resize(3 * static_cast<std::size_t>(width) * height);
+        for (int y = 0; y < height; ++y) {
+            const unsigned char* source = image.pixels.data() + 4 * static_cast<std::size_t>(height - 1 - y) * width;
+            unsigned char* target = rgb.data() + 3 * static_cast<std::size_t>(y) * width;
+            for (int x = 0; x < width; ++x) std::memcpy(target + 3 * x, source + 4 * x, 3);
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%05d.png", image.frame);
+        util::writePNG(folder / name, rgb.data(), width, height, 3);
+        lock.lock();
+        spare.push_back(std::move(image.pixels));
+        --encoding;
+        image_done.notify_all();
+    }
+}
+}  // namespace graphics
@@ -0,0 +1,43 @@
+#include "graphics/frame_uniforms.h"
+
+#include "graphics/camera.h"
+#include "graphics/configs.h"
+#include "graphics/shader.h"
+
+namespace graphics {
+FrameUniforms::FrameUniforms() noexcept {
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, g_FrameUniformBinding, ubo);
+}
+
+FrameUniforms::~FrameUniforms() { glDeleteBuffers(1, &ubo); }
+
+bool FrameUniforms::attach(Program* program) {
+    return program->bindUniformBlock(blockName, g_FrameUniformBinding, sizeof(Block));
+}
+
+void FrameUniforms::setCamera(const Camera& camera) {
+    Eigen::Map<Eigen::Matrix4f>(block.VP) = camera.getViewWithProjectionMatrix();
+    Eigen::Map<Eigen::Matrix4f>(block.view) = camera.getViewMatrix();
+    Eigen::Map<Eigen::Matrix4f>(block.projection) = camera.getProjectionMatrix();
+    Eigen::Map<Eigen::Vector4f>(block.viewPos) = camera.getPosition();
+    isDirty = true;
+}
+
+void FrameUniforms::setLight(const Eigen::Vector4f& position, const Eigen::Matrix4f& lightSpaceMatrix) {
+    Eigen::Map<Eigen::Vector4f>(block.lightPos) = position;
+    Eigen::Map<Eigen::Matrix4f>(block.lightSpaceMatrix) = lightSpaceMatrix;
+    isDirty = true;
+}
+
+void FrameUniforms::update() {
+    if (!isDirty) return;
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    isDirty = false;
+}
+}  // namespace graphics
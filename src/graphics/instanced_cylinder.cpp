@@ -0,0 +1,201 @@
+#include "graphics/instanced_cylinder.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "graphics/cylinder.h"
+#include "graphics/shader.h"
+
+namespace graphics {
+namespace {
+// First attribute location after position, normal and texture coordinate
+constexpr GLuint instance_location = 3;
+}  // namespace
+
+InstancedCylinder::InstancedCylinder() noexcept : InstancedCylinder(0) {}
+
+InstancedCylinder::InstancedCylinder(int instance_num) noexcept {
+    {
+        // A temporary cylinder generates the shared mesh on first use
+        Cylinder mesh;
+        vbo = mesh.vbo;
+        ebo = mesh.ebo;
+    }
+    setupVertexArray();
+    resize(instance_num);
+}
+
+InstancedCylinder::InstancedCylinder(const InstancedCylinder& other) noexcept
+    : revision(other.revision), instances(other.instances), vbo(other.vbo), ebo(other.ebo) {
+    setupVertexArray();
+}
+
+InstancedCylinder::InstancedCylinder(InstancedCylinder&& other) noexcept
+    : vao(std::exchange(other.vao, 0)),
+      instance_vbo(std::exchange(other.instance_vbo, 0)),
+      instance_capacity(std::exchange(other.instance_capacity, 0)),
+      isDirty(other.isDirty),
+      revision(other.revision),
+      instances(std::move(other.instances)),
+      vbo(std::move(other.vbo)),
+      ebo(std::move(other.ebo)) {}
+
+InstancedCylinder& InstancedCylinder::operator=(const InstancedCylinder& other) noexcept {
+    if (this != &other) {
+        instances = other.instances;
+        isDirty = true;
+        ++revision;
+    }
+    return *this;
+}
+
+InstancedCylinder& InstancedCylinder::operator=(InstancedCylinder&& other) noexcept {
+    if (this != &other) {
+        std::swap(vao, other.vao);
+        std::swap(instance_vbo, other.instance_vbo);
+        std::swap(instance_capacity, other.instance_capacity);
+        isDirty = other.isDirty;
+        ++revision;
+        instances = std::move(other.instances);
+        vbo = std::move(other.vbo);
+        ebo = std::move(other.ebo);
+    }
+    return *this;
+}
+
+InstancedCylinder::~InstancedCylinder() {
+    glDeleteBuffers(1, &instance_vbo);
+    glDeleteVertexArrays(1, &vao);
+}
+
+int InstancedCylinder::getInstanceNum() const { return static_cast<int>(instances.size()); }
+
+unsigned int InstancedCylinder::getRevision() const { return revision; }
+
+void InstancedCylinder::resize(int instance_num) {
+    const int old_num = getInstanceNum();
+    instances.resize(instance_num);
+    for (int i = old_num; i < instance_num; ++i) {
+        setModelMatrix(i, Eigen::AffineCompact3f::Identity());
+        setColor(i, Eigen::Vector4f::UnitX());
+    }
+    isDirty = true;
+    ++revision;
+}
+
+void InstancedCylinder::setModelMatrices(const std::vector<Eigen::AffineCompact3f>& model_matrices) {
+    const int instance_num = std::min(getInstanceNum(), static_cast<int>(model_matrices.size()));
+    for (int i = 0; i < instance_num; ++i) setModelMatrix(i, model_matrices[i]);
+}
+
+void InstancedCylinder::setModelMatrices(const std::vector<Eigen::AffineCompact3f>& model_matrices,
+                                         const std::vector<Eigen::Matrix3f>& normal_matrices) {
+    const int instance_num = std::min({getInstanceNum(), static_cast<int>(model_matrices.size()),
+                                       static_cast<int>(normal_matrices.size())});
+    for (int i = 0; i < instance_num; ++i) setModelMatrix(i, model_matrices[i], normal_matrices[i]);
+}
+
+void InstancedCylinder::setModelMatrix(int idx, const Eigen::AffineCompact3f& model_matrix,
+                                       const Eigen::Matrix3f& normal_matrix) {
+    Instance& instance = instances[idx];
+    Eigen::Map<Eigen::Matrix<float, 3, 4>> model(instance.model);
+    if (model == model_matrix.matrix()) return;
+    model = model_matrix.matrix();
+    Eigen::Map<Eigen::Matrix3f>(instance.normal) = normal_matrix;
+    isDirty = true;
+    ++revision;
+}
+
+void InstancedCylinder::setModelMatrix(int idx, const Eigen::AffineCompact3f& model_matrix) {
+    Instance& instance = instances[idx];
+    Eigen::Map<Eigen::Matrix<float, 3, 4>> model(instance.model);
+    // A settled pose sets the same matrices every frame
+    if (model == model_matrix.matrix()) return;
+    model = model_matrix.matrix();
+    // Normals only need the inverse transpose of the linear part
+    Eigen::Map<Eigen::Matrix3f>(instance.normal) = model_matrix.linear().inverse().transpose();
+    isDirty = true;
+    ++revision;
+}
+
+void InstancedCylinder::setColor(const Eigen::Vector4f& color) {
+    for (int i = 0; i < getInstanceNum(); ++i) setColor(i, color);
+}
+
+void InstancedCylinder::setColor(int idx, const Eigen::Vector4f& color) {
+    Eigen::Map<Eigen::Vector4f> instanceColor(instances[idx].color);
+    if (instanceColor == color) return;
+    instanceColor = color;
+    isDirty = true;
+    ++revision;
+}
+
+void InstancedCylinder::render(Program* shaderProgram) {
+    if (instances.empty()) return;
+    if (isDirty) {
+        const GLsizeiptr size = static_cast<GLsizeiptr>(instances.size() * sizeof(Instance));
+        glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+        if (size > instance_capacity) {
+            glBufferData(GL_ARRAY_BUFFER, size, instances.data(), GL_DYNAMIC_DRAW);
+            instance_capacity = size;
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        isDirty = false;
+    }
+    // One draw shares one level of detail, so use the level the largest instance on screen needs
+    float pixelRadius = 0.0f;
+    for (const Instance& instance : instances) {
+        Eigen::Map<const Eigen::Matrix<float, 3, 4>> model(instance.model);
+        pixelRadius = std::max(pixelRadius, LevelOfDetail::projectedRadius(
+                                                model.col(3), Cylinder::boundingRadius(model.leftCols<3>())));
+    }
+    const LodRange& range = Cylinder::lods[LevelOfDetail::select(g_CylinderSectors, pixelRadius)];
+    shaderProgram->setUniform(shaderProgram->getObjectUniforms().useTexture, 0);
+    glBindVertexArray(vao);
+    glDrawElementsInstanced(GL_TRIANGLES, range.count, GL_UNSIGNED_INT,
+                            reinterpret_cast<void*>(range.first * sizeof(GLuint)), getInstanceNum());
+    glBindVertexArray(0);
+}
+
+void InstancedCylinder::setupVertexArray() {
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &instance_vbo);
+    instance_capacity = 0;
+    isDirty = true;
+    glBindVertexArray(vao);
+    // Per-vertex attributes, same as Rigidbody::initialize
+    vbo->bind();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void*>(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void*>(6 * sizeof(GLfloat)));
+    // Per-instance attributes, a matrix takes one location per column
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    GLuint location = instance_location;
+    for (int column = 0; column < 4; ++column, ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<void*>(offsetof(Instance, model) + column * 3 * sizeof(GLfloat)));
+        glVertexAttribDivisor(location, 1);
+    }
+    for (int column = 0; column < 3; ++column, ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<void*>(offsetof(Instance, normal) + column * 3 * sizeof(GLfloat)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                          reinterpret_cast<void*>(offsetof(Instance, color)));
+    glVertexAttribDivisor(location, 1);
+    ebo->bind();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+}  // namespace graphics
@@ -0,0 +1,37 @@
+#include "graphics/level_of_detail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "graphics/configs.h"
+#include "util/helper.h"
+
+namespace graphics {
+Eigen::Vector4f LevelOfDetail::clipW = Eigen::Vector4f::UnitW();
+float LevelOfDetail::pixelScale = std::numeric_limits<float>::infinity();
+
+void LevelOfDetail::setViewProjection(const Eigen::Matrix4f& viewProjection, int viewportWidth, int viewportHeight) {
+    clipW = viewProjection.row(3).transpose();
+    // Clip space spans 2 units across the viewport, the longest row maps a world unit to the most pixels
+    pixelScale = 0.5f * std::max(viewProjection.row(0).head<3>().norm() * viewportWidth,
+                                 viewProjection.row(1).head<3>().norm() * viewportHeight);
+}
+
+float LevelOfDetail::projectedRadius(const Eigen::Vector3f& center, float radius) {
+    // Orthographic projections have w = 1 everywhere, perspective ones the distance along the view axis
+    const float w = clipW.head<3>().dot(center) + clipW.w();
+    const float nearest = w - radius * clipW.head<3>().norm();
+    if (nearest <= std::numeric_limits<float>::epsilon()) return std::numeric_limits<float>::infinity();
+    return radius * pixelScale / nearest;
+}
+
+int LevelOfDetail::select(const int* sectors, float pixelRadius) {
+    for (int level = g_LodLevels - 1; level > 0; --level) {
+        // Largest gap between a circle and its inscribed polygon is r * (1 - cos(pi / n))
+        const float error = pixelRadius * (1.0f - std::cos(static_cast<float>(util::PI) / sectors[level]));
+        if (error <= g_LodPixelError) return level;
+    }
+    return 0;
+}
+}  // namespace graphics
@@ -52,15 +52,16 @@ void Plane::generateVertices() {
 }
 
 void Plane::render(Program* shaderProgram) {
+    const ObjectUniforms& uniforms = shaderProgram->getObjectUniforms();
     if (texture) {
-        shaderProgram->setUniform("useTexture", 1);
-        shaderProgram->setUniform("diffuseTexture", texture->getIndex());
+        shaderProgram->setUniform(uniforms.useTexture, 1);
+        shaderProgram->setUniform(uniforms.diffuseTexture, texture->getIndex());
     } else {
-        shaderProgram->setUniform("useTexture", 0);
-        shaderProgram->setUniform("baseColor", baseColor);
+        shaderProgram->setUniform(uniforms.useTexture, 0);
+        shaderProgram->setUniform(uniforms.baseColor, baseColor);
     }
-    shaderProgram->setUniform("model", modelMatrix);
-    shaderProgram->setUniform("invtransmodel", inverseTransposeModel);
+    shaderProgram->setUniform(uniforms.model, modelMatrix);
+    shaderProgram->setUniform(uniforms.invtransmodel, inverseTransposeModel);
     glBindVertexArray(vao);
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
     glBindVertexArray(0);
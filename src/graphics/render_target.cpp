@@ -0,0 +1,68 @@
+#include "graphics/render_target.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace graphics {
+RenderTarget::RenderTarget(int _width, int _height) noexcept : width(_width), height(_height) {
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer of " << width << " * " << height << " is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+RenderTarget::~RenderTarget() {
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteFramebuffers(1, &fbo);
+}
+
+int RenderTarget::getWidth() const { return width; }
+
+int RenderTarget::getHeight() const { return height; }
+
+GLuint RenderTarget::getFrameBuffer() const { return fbo; }
+
+void RenderTarget::bind() const { glBindFramebuffer(GL_FRAMEBUFFER, fbo); }
+
+void RenderTarget::unbind() const { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+
+void RenderTarget::readPixels(std::vector<unsigned char>& rgb) const {
+    const std::size_t rowSize = 3 * static_cast<std::size_t>(width);
+    std::vector<unsigned char> flipped(rowSize * height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, flipped.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    // OpenGL reads bottom to top
+    rgb.resize(flipped.size());
+    for (int y = 0; y < height; ++y) {
+        std::copy_n(flipped.data() + (height - 1 - y) * rowSize, rowSize, rgb.data() + y * rowSize);
+    }
+}
+
+bool RenderTarget::writePPM(const util::fs::path& file_name) const {
+    std::vector<unsigned char> rgb;
+    readPixels(rgb);
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << file_name << std::endl;
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+    return static_cast<bool>(file);
+}
+}  // namespace graphics
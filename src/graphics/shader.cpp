@@ -1,6 +1,9 @@
 #include "graphics/shader.h"
 
+#include <algorithm>
 #include <fstream>
+#include <iostream>
+#include <string_view>
 
 namespace graphics {
 
@@ -49,11 +52,66 @@ void Program::link() {
         puts("Failed to link shader program!");
         puts(infoLog);
     }
+    cacheUniformLocations();
+    objectUniforms.useTexture = getUniformHandle<int>("useTexture");
+    objectUniforms.diffuseTexture = getUniformHandle<int>("diffuseTexture");
+    objectUniforms.baseColor = getUniformHandle<Eigen::Vector4f>("baseColor");
+    objectUniforms.model = getUniformHandle<Eigen::Affine3f>("model");
+    objectUniforms.invtransmodel = getUniformHandle<Eigen::Matrix4f>("invtransmodel");
+}
+
+void Program::cacheUniformLocations() {
+    uniformLocations.clear();
+    GLint uniformNum = 0, maxLength = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniformNum);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(std::max(maxLength, 1), '\0');
+    for (GLint i = 0; i < uniformNum; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(id, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+        std::string uniformName(name.data(), length);
+        GLint location = glGetUniformLocation(id, uniformName.c_str());
+        // Members of uniform blocks have no location
+        if (location == -1) continue;
+        // Arrays are reported as "name[0]", also cache them by their plain name
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+            uniformLocations.emplace_back(uniformName.substr(0, uniformName.size() - 3), location);
+        }
+        uniformLocations.emplace_back(std::move(uniformName), location);
+    }
+    std::sort(uniformLocations.begin(), uniformLocations.end());
 }
 
 GLuint Program::getID() const { return id; }
 
-int Program::getUniformLocation(const char* name) const { return glGetUniformLocation(id, name); }
+int Program::getUniformLocation(const char* name) const {
+    const std::string_view key(name);
+    auto iter = std::lower_bound(uniformLocations.begin(), uniformLocations.end(), key,
+                                 [](const auto& entry, std::string_view value) { return entry.first < value; });
+    if (iter != uniformLocations.end() && iter->first == key) return iter->second;
+    // Array elements or names that are not active, ask the driver once and remember the answer
+    GLint location = glGetUniformLocation(id, name);
+    uniformLocations.emplace(iter, std::string(key), location);
+    return location;
+}
+
+const ObjectUniforms& Program::getObjectUniforms() const { return objectUniforms; }
+
+bool Program::bindUniformBlock(const char* name, GLuint binding, GLint size) {
+    const GLuint blockIndex = glGetUniformBlockIndex(id, name);
+    if (blockIndex == GL_INVALID_INDEX) return true;
+    GLint blockSize = 0;
+    glGetActiveUniformBlockiv(id, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+    if (blockSize != size) {
+        std::cerr << "Uniform block " << name << " of program " << id << " is " << blockSize << " bytes, expected "
+                  << size << " bytes" << std::endl;
+        return false;
+    }
+    glUniformBlockBinding(id, blockIndex, binding);
+    return true;
+}
 
 void Program::use() const { glUseProgram(id); }
 
@@ -73,4 +131,18 @@ void Program::setUniform(const char* name, const Eigen::Vector3f& vec3) {
 void Program::setUniform(const char* name, const Eigen::Vector4f& vec4) {
     glUniform4fv(getUniformLocation(name), 1, vec4.data());
 }
+
+void Program::setUniform(UniformHandle<int> handle, int i1) { glUniform1i(handle.location, i1); }
+
+void Program::setUniform(UniformHandle<Eigen::Matrix4f> handle, const Eigen::Matrix4f& mat4) {
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, mat4.data());
+}
+
+void Program::setUniform(UniformHandle<Eigen::Affine3f> handle, const Eigen::Affine3f& mat4) {
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, mat4.data());
+}
+
+void Program::setUniform(UniformHandle<Eigen::Vector4f> handle, const Eigen::Vector4f& vec4) {
+    glUniform4fv(handle.location, 1, vec4.data());
+}
 }  // namespace graphics
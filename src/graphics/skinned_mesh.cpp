@@ -0,0 +1,105 @@
+#include "graphics/skinned_mesh.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+
+#include "graphics/configs.h"
+#include "graphics/shader.h"
+
+namespace graphics {
+SkinnedMesh::SkinnedMesh() noexcept : palette_buffer(16 * g_MaxSkinBones) {
+    for (int i = 0; i < g_MaxSkinBones; ++i) {
+        Eigen::Map<Eigen::Matrix4f>(palette_buffer.data() + 16 * i).setIdentity();
+    }
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glGenBuffers(1, &palette_ubo);
+    // Identity palette, so an unposed mesh is drawn in its bind pose
+    glBindBuffer(GL_UNIFORM_BUFFER, palette_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, palette_buffer.size() * sizeof(GLfloat), palette_buffer.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex),
+                          reinterpret_cast<void*>(offsetof(SkinnedVertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex),
+                          reinterpret_cast<void*>(offsetof(SkinnedVertex, normal)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex),
+                          reinterpret_cast<void*>(offsetof(SkinnedVertex, texCoord)));
+    // Bone indices stay integers in the shader
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, sizeof(SkinnedVertex),
+                           reinterpret_cast<void*>(offsetof(SkinnedVertex, bones)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex),
+                          reinterpret_cast<void*>(offsetof(SkinnedVertex, weights)));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+SkinnedMesh::~SkinnedMesh() {
+    glDeleteBuffers(1, &palette_ubo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+}
+
+bool SkinnedMesh::attach(Program* program) {
+    return program->bindUniformBlock(blockName, g_BonePaletteBinding, 16 * g_MaxSkinBones * sizeof(GLfloat));
+}
+
+void SkinnedMesh::setMesh(const std::vector<SkinnedVertex>& vertices, const std::vector<GLuint>& indices) {
+    // Reported once here, setBonePalette clamps every frame without a word
+    const bool outOfPalette = std::any_of(vertices.begin(), vertices.end(), [](const SkinnedVertex& vertex) {
+        return std::any_of(std::begin(vertex.bones), std::end(vertex.bones),
+                           [](GLubyte bone) { return bone >= g_MaxSkinBones; });
+    });
+    if (outOfPalette) {
+        std::cerr << "Skinned mesh uses bones past the first " << g_MaxSkinBones
+                  << ", which are not in the bone palette" << std::endl;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SkinnedVertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // The element buffer binding is part of the vertex array state
+    glBindVertexArray(vao);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    index_num = static_cast<GLsizei>(indices.size());
+}
+
+void SkinnedMesh::setBonePalette(const std::vector<Eigen::AffineCompact3f>& palette) {
+    palette_size = std::min(static_cast<int>(palette.size()), g_MaxSkinBones);
+    for (int i = 0; i < palette_size; ++i) {
+        // Top three rows of a column major mat4
+        Eigen::Map<Eigen::Matrix<float, 3, 4>, Eigen::Unaligned, Eigen::OuterStride<4>> skin(&palette_buffer[16 * i]);
+        skin = palette[i].matrix();
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, palette_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, 16 * palette_size * sizeof(GLfloat), palette_buffer.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void SkinnedMesh::setColor(const Eigen::Vector4f& color) { baseColor = color; }
+
+void SkinnedMesh::render(Program* shaderProgram) {
+    if (index_num == 0) return;
+    // Every mesh has its own palette, so bind it for this draw
+    glBindBufferBase(GL_UNIFORM_BUFFER, g_BonePaletteBinding, palette_ubo);
+    const ObjectUniforms& uniforms = shaderProgram->getObjectUniforms();
+    shaderProgram->setUniform(uniforms.useTexture, 0);
+    shaderProgram->setUniform(uniforms.baseColor, baseColor);
+    glBindVertexArray(vao);
+    glDrawElements(GL_TRIANGLES, index_num, GL_UNSIGNED_INT, nullptr);
+    glBindVertexArray(0);
+}
+}  // namespace graphics
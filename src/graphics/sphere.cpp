@@ -8,12 +8,9 @@
 #include "util/helper.h"
 
 namespace graphics {
-namespace {
-constexpr GLsizei nFilled = 6 * g_SphereStacks * g_SphereSectors - 6 * g_SphereStacks;
-constexpr GLsizei nWire = 4 * g_SphereStacks * g_SphereSectors - 2 * g_SphereStacks;
-}  // namespace
-
 bool Sphere::isInitialized = false;
+std::array<LodRange, g_LodLevels> Sphere::fillLods;
+std::array<LodRange, g_LodLevels> Sphere::wireLods;
 std::weak_ptr<Buffer<1, GL_ARRAY_BUFFER>> Sphere::vbo_weak;
 std::weak_ptr<Buffer<2, GL_ELEMENT_ARRAY_BUFFER>> Sphere::ebo_weak;
 
@@ -64,59 +61,69 @@ Sphere& Sphere::operator=(Sphere&& other) noexcept {
 void Sphere::generateVertices() {
     // http://www.songho.ca/opengl/gl_sphere.html#sphere
     if (!Sphere::isInitialized) {
+        // Every level of detail is appended to the same buffers, indices are absolute
         std::vector<GLfloat> vertices;
         std::vector<GLuint> fillIndices, wireIndices;
-        vertices.reserve(8 * (g_SphereStacks + 1) * (g_SphereSectors + 1));
-        fillIndices.reserve(6 * g_SphereStacks * g_SphereSectors);
-        wireIndices.reserve(4 * g_SphereStacks * g_SphereSectors);
 
-        float x, y, z, xy;                                    //  position
-        float nx, ny, nz, lengthInv = 1.0f / g_SphereRadius;  //  normal
-        float s, t;                                           //  texCoord
+        for (int level = 0; level < g_LodLevels; ++level) {
+            const int sectors = g_SphereSectors[level];
+            const int stacks = g_SphereStacks[level];
+            const GLuint baseIndex = static_cast<GLuint>(vertices.size() / 8);
+            fillLods[level].first = static_cast<GLsizei>(fillIndices.size());
+            wireLods[level].first = static_cast<GLsizei>(wireIndices.size());
 
-        constexpr float sectorStep = static_cast<float>(2.0 * util::PI / g_SphereSectors);
-        constexpr float stackStep = static_cast<float>(util::PI / g_SphereStacks);
-        float sectorAngle, stackAngle;
+            float x, y, z, xy;                                    //  position
+            float nx, ny, nz, lengthInv = 1.0f / g_SphereRadius;  //  normal
+            float s, t;                                           //  texCoord
 
-        for (int i = 0; i <= g_SphereStacks; ++i) {
-            stackAngle = static_cast<float>(util::PI / 2.0 - i * stackStep);  // [pi/2, -pi/2]
-            xy = cosf(stackAngle);                                            // r * cos(u)
-            z = sinf(stackAngle);                                             // r * sin(u)
+            const float sectorStep = static_cast<float>(2.0 * util::PI / sectors);
+            const float stackStep = static_cast<float>(util::PI / stacks);
+            float sectorAngle, stackAngle;
 
-            for (int j = 0; j <= g_SphereSectors; ++j) {
-                sectorAngle = j * sectorStep;  // [0, 2pi]
+            for (int i = 0; i <= stacks; ++i) {
+                stackAngle = static_cast<float>(util::PI / 2.0 - i * stackStep);  // [pi/2, -pi/2]
+                xy = cosf(stackAngle);                                            // r * cos(u)
+                z = sinf(stackAngle);                                             // r * sin(u)
 
-                x = xy * cosf(sectorAngle);  // r * cos(u) * cos(v)
-                y = xy * sinf(sectorAngle);  // r * cos(u) * sin(v)
+                for (int j = 0; j <= sectors; ++j) {
+                    sectorAngle = j * sectorStep;  // [0, 2pi]
 
-                // normalized vertex normal (nx, ny, nz)
-                nx = x * lengthInv;
-                ny = y * lengthInv;
-                nz = z * lengthInv;
+                    x = xy * cosf(sectorAngle);  // r * cos(u) * cos(v)
+                    y = xy * sinf(sectorAngle);  // r * cos(u) * sin(v)
 
-                // vertex tex coord (s, t) range between [0, 1]
-                s = static_cast<float>(j) / g_SphereSectors;
-                t = static_cast<float>(i) / g_SphereStacks;
+                    // normalized vertex normal (nx, ny, nz)
+                    nx = x * lengthInv;
+                    ny = y * lengthInv;
+                    nz = z * lengthInv;
 
-                vertices.insert(vertices.end(), {x, y, z, nx, ny, nz, s, t});
-            }
-        }
+                    // vertex tex coord (s, t) range between [0, 1]
+                    s = static_cast<float>(j) / sectors;
+                    t = static_cast<float>(i) / stacks;
 
-        unsigned int k1, k2;  // EBO index
-        for (int i = 0; i < g_SphereStacks; ++i) {
-            k1 = i * (g_SphereSectors + 1);  // beginning of current stack
-            k2 = k1 + g_SphereSectors + 1;   // beginning of next stack
-            for (int j = 0; j < g_SphereSectors; ++j, ++k1, ++k2) {
-                wireIndices.insert(wireIndices.end(), {k1, k2});
-                if (i != 0) {
-                    wireIndices.insert(wireIndices.end(), {k1, k1 + 1});
-                    fillIndices.insert(fillIndices.end(), {k1, k2, k1 + 1});
+                    vertices.insert(vertices.end(), {x, y, z, nx, ny, nz, s, t});
                 }
-                // k1+1 => k2 => k2+1
-                if (i != (g_SphereStacks - 1)) {
-                    fillIndices.insert(fillIndices.end(), {k1 + 1, k2, k2 + 1});
+            }
+
+            unsigned int k1, k2;  // EBO index
+            for (int i = 0; i < stacks; ++i) {
+                k1 = baseIndex + i * (sectors + 1);  // beginning of current stack
+                k2 = k1 + sectors + 1;               // beginning of next stack
+                for (int j = 0; j < sectors; ++j, ++k1, ++k2) {
+                    wireIndices.insert(wireIndices.end(), {k1, k2});
+                    if (i != 0) {
+                        wireIndices.insert(wireIndices.end(), {k1, k1 + 1});
+                        fillIndices.insert(fillIndices.end(), {k1, k2, k1 + 1});
+                    }
+                    // k1+1 => k2 => k2+1
+                    if (i != (stacks - 1)) {
+                        fillIndices.insert(fillIndices.end(), {k1 + 1, k2, k2 + 1});
+                    }
                 }
             }
+            fillLods[level].count = static_cast<GLsizei>(fillIndices.size()) - fillLods[level].first;
+            wireLods[level].count = static_cast<GLsizei>(wireIndices.size()) - wireLods[level].first;
+            assert(fillLods[level].count == 6 * stacks * sectors - 6 * sectors);
+            assert(wireLods[level].count == 4 * stacks * sectors - 2 * sectors);
         }
         vbo->bind();
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
@@ -126,28 +133,34 @@ void Sphere::generateVertices() {
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, fillIndices.size() * sizeof(GLuint), fillIndices.data(), GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        assert(wireIndices.size() == nWire);
-        assert(fillIndices.size() == nFilled);
         Sphere::isInitialized = true;
     }
 }
 void Sphere::bindVBO() const { vbo->bind(); }
 
 void Sphere::render(Program* shaderProgram) {
+    const ObjectUniforms& uniforms = shaderProgram->getObjectUniforms();
     if (texture) {
-        shaderProgram->setUniform("useTexture", 1);
-        shaderProgram->setUniform("diffuseTexture", texture->getIndex());
+        shaderProgram->setUniform(uniforms.useTexture, 1);
+        shaderProgram->setUniform(uniforms.diffuseTexture, texture->getIndex());
     } else {
-        shaderProgram->setUniform("useTexture", 0);
-        shaderProgram->setUniform("baseColor", baseColor);
+        shaderProgram->setUniform(uniforms.useTexture, 0);
+        shaderProgram->setUniform(uniforms.baseColor, baseColor);
     }
-    shaderProgram->setUniform("model", modelMatrix);
-    shaderProgram->setUniform("invtransmodel", inverseTransposeModel);
+    shaderProgram->setUniform(uniforms.model, modelMatrix);
+    shaderProgram->setUniform(uniforms.invtransmodel, inverseTransposeModel);
+    // Bounds are the unit sphere under the model matrix
+    const float radius = g_SphereRadius * modelMatrix.linear().colwise().norm().maxCoeff();
+    const int level = LevelOfDetail::select(
+        g_SphereSectors, LevelOfDetail::projectedRadius(modelMatrix.translation(), radius));
     glBindVertexArray(vao);
     if (mode == RenderMode::FILLED) {
-        glDrawElements(GL_TRIANGLES, nFilled, GL_UNSIGNED_INT, nullptr);
+        const LodRange& range = fillLods[level];
+        glDrawElements(GL_TRIANGLES, range.count, GL_UNSIGNED_INT,
+                       reinterpret_cast<void*>(range.first * sizeof(GLuint)));
     } else {
-        glDrawElements(GL_LINES, nWire, GL_UNSIGNED_INT, nullptr);
+        const LodRange& range = wireLods[level];
+        glDrawElements(GL_LINES, range.count, GL_UNSIGNED_INT, reinterpret_cast<void*>(range.first * sizeof(GLuint)));
     }
     glBindVertexArray(0);
 }
@@ -71,10 +71,27 @@ ShadowMapTexture::ShadowMapTexture(unsigned int size) {
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, id, 0);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
+    // Same format as the shadow map so it can be blitted, never sampled
+    glGenTextures(1, &staticDepthMap);
+    glGenFramebuffers(1, &staticDepthMapFBO);
+    glBindTexture(GL_TEXTURE_2D, staticDepthMap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glBindFramebuffer(GL_FRAMEBUFFER, staticDepthMapFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, staticDepthMap, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glActiveTexture(GL_TEXTURE0 + getIndex());
+    glBindTexture(GL_TEXTURE_2D, id);
 }
 
-ShadowMapTexture::~ShadowMapTexture() { glDeleteFramebuffers(1, &depthMapFBO); }
+ShadowMapTexture::~ShadowMapTexture() {
+    glDeleteFramebuffers(1, &staticDepthMapFBO);
+    glDeleteTextures(1, &staticDepthMap);
+    glDeleteFramebuffers(1, &depthMapFBO);
+}
 
 unsigned int ShadowMapTexture::getShadowSize() const { return shadowSize; }
 
@@ -82,6 +99,24 @@ void ShadowMapTexture::bindFrameBuffer() const { glBindFramebuffer(GL_FRAMEBUFFE
 
 void ShadowMapTexture::unbindFrameBuffer() const { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
 
+bool ShadowMapTexture::hasStaticCache() const { return isStaticCached; }
+
+void ShadowMapTexture::beginStaticCache() const { glBindFramebuffer(GL_FRAMEBUFFER, staticDepthMapFBO); }
+
+void ShadowMapTexture::endStaticCache() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    isStaticCached = true;
+}
+
+void ShadowMapTexture::invalidateStaticCache() { isStaticCached = false; }
+
+void ShadowMapTexture::restoreStaticCache() const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, staticDepthMapFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthMapFBO);
+    glBlitFramebuffer(0, 0, shadowSize, shadowSize, 0, 0, shadowSize, shadowSize, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+}
+
 CubeTexture::CubeTexture(const util::fs::path &fileName) {
     stbi_set_flip_vertically_on_load(false);
     std::string temp = fileName.string();
@@ -8,6 +8,114 @@
 #define M_PI 3.1415
 
 namespace kinematics {
+namespace {
+std::vector<const GeneratedSolver*>& generatedSolvers() {
+    // Function local static, so registration order during static initialization does not matter
+    static std::vector<const GeneratedSolver*> solvers;
+    return solvers;
+}
+}  // namespace
+
+bool registerGeneratedSolver(const GeneratedSolver* solver) {
+    generatedSolvers().push_back(solver);
+    return true;
+}
+
+const GeneratedSolver* findGeneratedSolver(std::uint64_t fingerprint) {
+    for (const GeneratedSolver* solver : generatedSolvers()) {
+        if (solver->fingerprint == fingerprint) return solver;
+    }
+    return nullptr;
+}
+
+void forwardSolver(const acclaim::Posture& posture, const acclaim::Bone* bone, acclaim::Pose& pose) {
+    util::rotateDegreeZYX(posture.bone_rotations, pose.local_rotations);
+    std::vector<const acclaim::Bone*> stack{bone};
+    while (!stack.empty()) {
+        const acclaim::Bone* current = stack.back();
+        stack.pop_back();
+        const int idx = current->idx;
+        if (idx >= static_cast<int>(pose.transforms.size())) {
+            pose.transforms.resize(idx + 1, util::RigidTransform::Identity());
+            pose.end_positions.resize(idx + 1, Eigen::Vector4d::Zero());
+        }
+        util::RigidTransform& transform = pose.transforms[idx];
+        const acclaim::Bone* parent = current->parent;
+        if (parent == nullptr) {
+            // Root is placed by its translation channels
+            transform.translation = posture.bone_translations[idx].head<3>();
+            transform.rotation = current->rot_parent_current * pose.local_rotations[idx];
+        } else {
+            transform.translation = pose.end_positions[parent->idx].head<3>();
+            transform.rotation =
+                pose.transforms[parent->idx].rotation * current->rot_parent_current * pose.local_rotations[idx];
+        }
+        const Eigen::Vector3d offset = (current->dir * current->length).head<3>();
+        pose.end_positions[idx] << transform * offset, 0.0;
+        for (const acclaim::Bone* child = current->child; child != nullptr; child = child->sibling) {
+            stack.push_back(child);
+        }
+    }
+}
+
+void boneMatrices(const acclaim::Skeleton& skeleton, const acclaim::Pose& pose,
+                  std::vector<Eigen::AffineCompact3f>& model_matrices, std::vector<Eigen::Matrix3f>& normal_matrices) {
+    const int bone_num = skeleton.getBoneNum();
+    model_matrices.resize(bone_num);
+    normal_matrices.resize(bone_num);
+    const Eigen::Matrix3d* facings = skeleton.getBoneFacings().data();
+    const Eigen::Matrix3d* normal_facings = skeleton.getBoneNormalFacings().data();
+    const util::RigidTransform* transforms = pose.transforms.data();
+    const Eigen::Vector4d* end_positions = pose.end_positions.data();
+    for (int idx = 0; idx < bone_num; ++idx) {
+        // Cylinder centered at the bone's midpoint, oriented by its global rotation and initial facing.
+        // Facings carry the bone length as scaling, rotations are orthonormal so (R * F)^-T = R * F^-T.
+        const Eigen::Matrix3d rotation = transforms[idx].rotation.toRotationMatrix();
+        model_matrices[idx].linear() = (rotation * facings[idx]).cast<float>();
+        model_matrices[idx].translation() =
+            (0.5 * (transforms[idx].translation + end_positions[idx].head<3>())).cast<float>();
+        normal_matrices[idx] = (rotation * normal_facings[idx]).cast<float>();
+    }
+}
+
+void forwardSolver(const acclaim::Posture& posture, const acclaim::Skeleton& skeleton, acclaim::Pose& pose,
+                   std::vector<Eigen::AffineCompact3f>& model_matrices, std::vector<Eigen::Matrix3f>& normal_matrices,
+                   const GeneratedSolver* generated) {
+    // Generated kernels always evaluate the whole skeleton
+    if (generated != nullptr) {
+        generated->forwardSolver(posture, pose);
+    } else {
+        forwardSolver(posture, skeleton.getBonePointer(acclaim::Skeleton::root_idx()), pose);
+    }
+    boneMatrices(skeleton, pose, model_matrices, normal_matrices);
+}
+
+void chainJacobian(const acclaim::Bone* end_bone, int bone_num, const acclaim::Pose& pose,
+                   const Eigen::Vector4d& target_pos, Eigen::Matrix4Xd& Jacobian) {
+    const acclaim::Bone* temp_bone = end_bone;
+    for (int i = 0; i < bone_num; i++) {
+        const int jacobianCount = i * 3;
+        const util::RigidTransform& transform = pose.transforms[temp_bone->idx];
+        const Eigen::Vector4d start_position(transform.translation.x(), transform.translation.y(),
+                                             transform.translation.z(), 0.0);
+
+        if (temp_bone->dofrx) {
+            Eigen::Vector4d rotationAxisX = (transform * Eigen::Vector4d(1, 0, 0, 0)).normalized();
+            Jacobian.col(jacobianCount + 0) = rotationAxisX.cross3(target_pos - start_position);
+        }
+        if (temp_bone->dofry) {
+            Eigen::Vector4d rotationAxisY = (transform * Eigen::Vector4d(0, 1, 0, 0)).normalized();
+            Jacobian.col(jacobianCount + 1) = rotationAxisY.cross3(target_pos - start_position);
+        }
+        if (temp_bone->dofrz) {
+            Eigen::Vector4d rotationAxisZ = (transform * Eigen::Vector4d(0, 0, 1, 0)).normalized();
+            Jacobian.col(jacobianCount + 2) = rotationAxisZ.cross3(target_pos - start_position);
+        }
+
+        temp_bone = temp_bone->parent;
+    }
+}
+
 Eigen::VectorXd pseudoInverseLinearSolver(const Eigen::Matrix4Xd& Jacobian, const Eigen::Vector4d& target) {
     // TODO
     // You need to return the solution (x) of the linear least squares system:
@@ -31,30 +139,34 @@ Eigen::VectorXd pseudoInverseLinearSolver(const Eigen::Matrix4Xd& Jacobian, cons
  * @param start_bone This bone is the last bone you can move while doing IK
  * @param end_bone This bone will try to reach `target_pos`
  * @param posture The original AMC motion's reference, you need to modify this
+ * @param pose Caller-owned buffer for the global bone transforms computed while solving
+ * @param generated Kernels generated for this skeleton, nullptr to use the generic path
  *
  * @return True if IK is stable (HW3 bonus)
  */
-bool inverseJacobianIKSolver(const Eigen::Vector4d& target_pos, acclaim::Bone* start_bone, acclaim::Bone* end_bone,
-                             acclaim::Posture& posture) {
+bool inverseJacobianIKSolver(const Eigen::Vector4d& target_pos, const acclaim::Bone* start_bone,
+                             const acclaim::Bone* end_bone, acclaim::Posture& posture, acclaim::Pose& pose,
+                             const GeneratedSolver* generated) {
     constexpr int max_iteration = 1000;
     constexpr double epsilon = 1E-3;
     constexpr double step = 0.1;
 
     // Since bone stores in bones[i] that i == bone->idx, we can use bone - bone->idx to find bones[0] which is root.
-    acclaim::Bone* root_bone = start_bone - start_bone->idx;
+    const acclaim::Bone* root_bone = start_bone - start_bone->idx;
 
     // TODO
     // Perform inverse kinematics (IK)
     // HINTs will tell you what should do in that area.
     // Of course you can ignore it (Any code below this line) and write your own code.
 
-    acclaim::Bone* temp_bone = end_bone;
+    const acclaim::Bone* temp_bone = end_bone;
     size_t bone_num = 1;
 
     while (temp_bone != start_bone) {
         if (temp_bone == root_bone) {
+            const Eigen::Vector3d& root_position = pose.transforms[root_bone->idx].translation;
             double targetStartingLength =
-                sqrt((target_pos - root_bone->start_position).dot(target_pos - root_bone->start_position));
+                sqrt((target_pos.head<3>() - root_position).dot(target_pos.head<3>() - root_position));
             break;
         }
 
@@ -66,11 +178,20 @@ bool inverseJacobianIKSolver(const Eigen::Vector4d& target_pos, acclaim::Bone* s
     // calculate number of bones need to move to perform IK, store in `bone_num`
     // a.k.a. how may bones from end_bone to its parent than to start_bone (include both side)
 
+    // The chain is fixed for the whole solve, so the unrolled kernel is looked up once
+    const ChainJacobian generated_jacobian =
+        generated != nullptr ? generated->chainJacobians[end_bone->idx * generated->bone_num + start_bone->idx]
+                             : nullptr;
+
     for (int iter = 0; iter < max_iteration; iter++) {
 
-        forwardSolver(posture, root_bone);
+        if (generated != nullptr) {
+            generated->forwardSolver(posture, pose);
+        } else {
+            forwardSolver(posture, root_bone, pose);
+        }
 
-        Eigen::Vector4d desiredVector = target_pos - end_bone->end_position;
+        Eigen::Vector4d desiredVector = target_pos - pose.end_positions[end_bone->idx];
         if (desiredVector.norm() < epsilon) {
             return true;
         }
@@ -81,26 +202,10 @@ bool inverseJacobianIKSolver(const Eigen::Vector4d& target_pos, acclaim::Bone* s
         Eigen::Matrix4Xd Jacobian(4, 3 * bone_num);
         Jacobian.setZero();
 
-        acclaim::Bone* temp_bone = end_bone;
-
-        for (int i = 0; i < bone_num; i++) {
-
-            int jacobianCount = i * 3;
-
-            if (temp_bone->dofrx) {
-                Eigen::Vector4d rotationAxisX = (temp_bone->rotation * Eigen::Vector4d(1, 0, 0, 0)).normalized();
-                Jacobian.col(jacobianCount + 0) = rotationAxisX.cross3(target_pos - temp_bone->start_position);
-            }
-            if (temp_bone->dofry) {
-                Eigen::Vector4d rotationAxisY = (temp_bone->rotation * Eigen::Vector4d(0, 1, 0, 0)).normalized();
-                Jacobian.col(jacobianCount + 1) = rotationAxisY.cross3(target_pos - temp_bone->start_position);
-            }
-            if (temp_bone->dofrz) {
-                Eigen::Vector4d rotationAxisZ = (temp_bone->rotation * Eigen::Vector4d(0, 0, 1, 0)).normalized();
-                Jacobian.col(jacobianCount + 2) = rotationAxisZ.cross3(target_pos - temp_bone->start_position);
-            }
-
-            temp_bone = temp_bone->parent;
+        if (generated_jacobian != nullptr) {
+            generated_jacobian(pose, target_pos, Jacobian);
+        } else {
+            chainJacobian(end_bone, static_cast<int>(bone_num), pose, target_pos, Jacobian);
         }
 
         Eigen::VectorXd deltatheta = step * pseudoInverseLinearSolver(Jacobian, desiredVector);
@@ -0,0 +1,115 @@
+#include "simulation/simulation_thread.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "acclaim/skeleton.h"
+
+namespace kinematics {
+namespace {
+// Sleep between polls of the input queue while there is nothing to solve
+constexpr std::chrono::milliseconds idle_period(1);
+}  // namespace
+
+SimulationThread::SimulationThread(const acclaim::Motion &_motion, const Eigen::Vector4d &_target, int _start_bone,
+                                   int _end_bone) noexcept
+    : motion(_motion), backup(_motion), target(_target), start_bone(_start_bone), end_bone(_end_bone) {
+    solve();
+    worker = std::thread(&SimulationThread::run, this);
+}
+
+SimulationThread::~SimulationThread() {
+    stopping.store(true, std::memory_order_relaxed);
+    worker.join();
+}
+
+bool SimulationThread::setTarget(const Eigen::Vector4d &_target) {
+    Input input;
+    input.type = Input::Type::Target;
+    input.target = _target;
+    return post(input);
+}
+
+bool SimulationThread::setBones(int _start_bone, int _end_bone) {
+    Input input;
+    input.type = Input::Type::Bones;
+    input.start_bone = _start_bone;
+    input.end_bone = _end_bone;
+    return post(input);
+}
+
+bool SimulationThread::reset() {
+    Input input;
+    input.type = Input::Type::Reset;
+    return post(input);
+}
+
+bool SimulationThread::exportMotion(const util::fs::path &file_stem) {
+    Input input;
+    input.type = Input::Type::Export;
+    input.file_stem = file_stem;
+    return post(input);
+}
+
+bool SimulationThread::update() { return frames.update(); }
+
+void SimulationThread::synchronize() {
+    bool is_new = false;
+    while (true) {
+        is_new = frames.update() || is_new;
+        const SimulationFrame &frame = frames.front();
+        if (frame.sequence > 0 && frame.input_count == posted_count && (frame.is_stable || is_new)) return;
+        std::this_thread::yield();
+    }
+}
+
+const SimulationFrame &SimulationThread::getFrame() const { return frames.front(); }
+
+bool SimulationThread::post(const Input &input) {
+    if (!inputs.push(input)) return false;
+    ++posted_count;
+    return true;
+}
+
+void SimulationThread::solve() {
+    is_stable = motion.inverseKinematics(target, start_bone, end_bone);
+    // Copies into the buffers of an older frame, so there is no allocation once all three slots are filled
+    SimulationFrame &frame = frames.back();
+    frame.pose = motion.getPose();
+    frame.model_matrices = motion.getModelMatrices();
+    frame.normal_matrices = motion.getNormalMatrices();
+    frame.is_stable = is_stable;
+    frame.input_count = applied_count;
+    frame.sequence = ++sequence;
+    frames.publish();
+}
+
+void SimulationThread::run() {
+    Input input;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        bool has_input = false;
+        while (inputs.pop(input)) {
+            switch (input.type) {
+                case Input::Type::Target: target = input.target; break;
+                case Input::Type::Bones:
+                    start_bone = input.start_bone;
+                    end_bone = input.end_bone;
+                    break;
+                case Input::Type::Reset: motion = backup; break;
+                case Input::Type::Export:
+                    motion.getSkeleton()->writeASFFile(util::fs::path(input.file_stem).concat(".asf"));
+                    motion.writeAMCFile(util::fs::path(input.file_stem).concat(".amc"));
+                    break;
+            }
+            ++applied_count;
+            has_input = true;
+        }
+        // Every input is answered by a frame, so synchronize() can tell when it has been applied
+        if (has_input || (!is_stable && !frames.hasUnread())) {
+            solve();
+        } else {
+            std::this_thread::sleep_for(idle_period);
+        }
+    }
+}
+}  // namespace kinematics
@@ -3,9 +3,57 @@
 
 namespace util {
 namespace {
-Eigen::AngleAxisd rotateRadianX(double x) { return Eigen::AngleAxisd(x, Eigen::Vector3d::UnitX()); }
-Eigen::AngleAxisd rotateRadianY(double y) { return Eigen::AngleAxisd(y, Eigen::Vector3d::UnitY()); }
-Eigen::AngleAxisd rotateRadianZ(double z) { return Eigen::AngleAxisd(z, Eigen::Vector3d::UnitZ()); }
+// Branch-free sin and cos of an angle in degrees, loops over it can be vectorized by the compiler.
+// The angle is reduced to [-45, 45] degrees by whole quadrants (exact in degrees), then evaluated by the
+// fdlibm kernel polynomials which are accurate to about 1 ulp in that range.
+inline void sinCosDegree(double degree, double& sine, double& cosine) {
+    const double quadrant = std::nearbyint(degree * (1.0 / 90.0));
+    const double x = (degree - quadrant * 90.0) * (PI / 180.0);
+    const double z = x * x;
+    const double s = x + x * z *
+                             (-1.66666666666666324348e-01 +
+                              z * (8.33333333332248946124e-03 +
+                                   z * (-1.98412698298579493134e-04 +
+                                        z * (2.75573137070700676789e-06 +
+                                             z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)))));
+    const double c = 1.0 - 0.5 * z +
+                     z * z *
+                         (4.16666666666666019037e-02 +
+                          z * (-1.38888888888741095749e-03 +
+                               z * (2.48015872894767294178e-05 +
+                                    z * (-2.75573143513906633035e-07 +
+                                         z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+    // sin(x + q * 90) cycles through (s, c), (c, -s), (-s, -c), (-c, s).
+    // Only q mod 4 matters, clamped so NaN or infinite angles cannot make the int conversion undefined
+    const double wrapped = quadrant - 4.0 * std::floor(0.25 * quadrant);
+    const int q = static_cast<int>(std::fmin(std::fmax(wrapped, 0.0), 3.0));
+    const double swapped_sine = (q & 1) ? c : s;
+    const double swapped_cosine = (q & 1) ? s : c;
+    sine = (q & 2) ? -swapped_sine : swapped_sine;
+    cosine = ((q + 1) & 2) ? -swapped_cosine : swapped_cosine;
+}
+// sin and cos of the three angles, evaluated once and shared by every element of the result
+struct EulerSinCos {
+    double sx, cx, sy, cy, sz, cz;
+    EulerSinCos(double x, double y, double z)
+        : sx(std::sin(x)), cx(std::cos(x)), sy(std::sin(y)), cy(std::cos(y)), sz(std::sin(z)), cz(std::cos(z)) {}
+    // Angles in degrees
+    explicit EulerSinCos(const Eigen::Vector4d& degree) {
+        sinCosDegree(degree[0], sx, cx);
+        sinCosDegree(degree[1], sy, cy);
+        sinCosDegree(degree[2], sz, cz);
+    }
+};
+// Closed form of qz * qy * qx, uses half angles
+Eigen::Quaterniond quaternionZYX(const EulerSinCos& t) {
+    return Eigen::Quaterniond(t.cz * t.cy * t.cx + t.sz * t.sy * t.sx, t.cz * t.cy * t.sx - t.sz * t.sy * t.cx,
+                              t.cz * t.sy * t.cx + t.sz * t.cy * t.sx, t.sz * t.cy * t.cx - t.cz * t.sy * t.sx);
+}
+// Closed form of qx * qy * qz, uses half angles
+Eigen::Quaterniond quaternionXYZ(const EulerSinCos& t) {
+    return Eigen::Quaterniond(t.cx * t.cy * t.cz - t.sx * t.sy * t.sz, t.sx * t.cy * t.cz + t.cx * t.sy * t.sz,
+                              t.cx * t.sy * t.cz - t.sx * t.cy * t.sz, t.cx * t.cy * t.sz + t.sx * t.sy * t.cz);
+}
 }  // namespace
 
 Eigen::Vector4d toDegree(const Eigen::Vector4d& angle) { return angle * 180.0 / PI; }
@@ -52,23 +100,47 @@ Eigen::Matrix4f ortho(float left, float right, float bottom, float top, float zN
     return mat;
 }
 Eigen::Quaterniond rotateDegreeZYX(double x, double y, double z) {
-    return rotateRadianZYX(toRadian(x), toRadian(y), toRadian(z));
+    return rotateDegreeZYX(Eigen::Vector4d(x, y, z, 0.0));
+}
+Eigen::Quaterniond rotateDegreeZYX(const Eigen::Vector4d& rotation) {
+    return quaternionZYX(EulerSinCos(Eigen::Vector4d(0.5 * rotation)));
 }
-Eigen::Quaterniond rotateDegreeZYX(const Eigen::Vector4d& rotation) { return rotateRadianZYX(toRadian(rotation)); }
 Eigen::Quaterniond rotateDegreeXYZ(double x, double y, double z) {
-    return rotateRadianXYZ(toRadian(x), toRadian(y), toRadian(z));
+    return rotateDegreeXYZ(Eigen::Vector4d(x, y, z, 0.0));
+}
+Eigen::Quaterniond rotateDegreeXYZ(const Eigen::Vector4d& rotation) {
+    return quaternionXYZ(EulerSinCos(Eigen::Vector4d(0.5 * rotation)));
 }
-Eigen::Quaterniond rotateDegreeXYZ(const Eigen::Vector4d& rotation) { return rotateRadianXYZ(toRadian(rotation)); }
 Eigen::Quaterniond rotateRadianZYX(double x, double y, double z) {
-    return rotateRadianZ(z) * rotateRadianY(y) * rotateRadianX(x);
+    return quaternionZYX(EulerSinCos(0.5 * x, 0.5 * y, 0.5 * z));
 }
 Eigen::Quaterniond rotateRadianZYX(const Eigen::Vector4d& rotation) {
-    return rotateRadianZ(rotation[2]) * rotateRadianY(rotation[1]) * rotateRadianX(rotation[0]);
+    return rotateRadianZYX(rotation[0], rotation[1], rotation[2]);
 }
 Eigen::Quaterniond rotateRadianXYZ(double x, double y, double z) {
-    return rotateRadianX(x) * rotateRadianY(y) * rotateRadianZ(z);
+    return quaternionXYZ(EulerSinCos(0.5 * x, 0.5 * y, 0.5 * z));
 }
 Eigen::Quaterniond rotateRadianXYZ(const Eigen::Vector4d& rotation) {
-    return rotateRadianX(rotation[0]) * rotateRadianY(rotation[1]) * rotateRadianZ(rotation[2]);
+    return rotateRadianXYZ(rotation[0], rotation[1], rotation[2]);
+}
+void rotateDegreeZYX(const std::vector<Eigen::Vector4d>& rotations, std::vector<Eigen::Quaterniond>& quaternions) {
+    const std::size_t size = rotations.size();
+    quaternions.resize(size);
+    if (size == 0) return;
+    // View the posture as one flat array (x, y, z, unused per bone), sin / cos of every half angle is one
+    // vectorized loop. Called on every IK iteration, so the scratch arrays are kept per thread
+    const double* degrees = rotations[0].data();
+    thread_local std::vector<double> sines, cosines;
+    sines.resize(4 * size);
+    cosines.resize(4 * size);
+    for (std::size_t i = 0; i < 4 * size; ++i) {
+        sinCosDegree(0.5 * degrees[i], sines[i], cosines[i]);
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        const double sx = sines[4 * i], sy = sines[4 * i + 1], sz = sines[4 * i + 2];
+        const double cx = cosines[4 * i], cy = cosines[4 * i + 1], cz = cosines[4 * i + 2];
+        quaternions[i] = Eigen::Quaterniond(cz * cy * cx + sz * sy * sx, cz * cy * sx - sz * sy * cx,
+                                            cz * sy * cx + sz * cy * sx, sz * cy * cx - cz * sy * sx);
+    }
 }
 }  // namespace util
@@ -0,0 +1,108 @@
+#include "util/mapped_file.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace util {
+MappedFile::MappedFile() noexcept {}
+
+MappedFile::MappedFile(const fs::path& file_name) noexcept { open(file_name); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : address(other.address), length(other.length), opened(other.opened) {
+    other.address = nullptr;
+    other.length = 0;
+    other.opened = false;
+}
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        address = std::exchange(other.address, nullptr);
+        length = std::exchange(other.length, 0);
+        opened = std::exchange(other.opened, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const fs::path& file_name) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(file_name.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open " << file_name << std::endl;
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file, &file_size);
+    length = static_cast<std::size_t>(file_size.QuadPart);
+    if (length != 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            address = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            // The view keeps the mapping alive
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    const int file = ::open(file_name.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Failed to open " << file_name << std::endl;
+        return false;
+    }
+    struct stat status;
+    fstat(file, &status);
+    length = static_cast<std::size_t>(status.st_size);
+    if (length != 0) {
+        void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED) {
+            address = static_cast<const char*>(mapping);
+            madvise(mapping, length, MADV_SEQUENTIAL);
+        }
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(file);
+#endif
+    if (length != 0 && address == nullptr) {
+        std::cerr << "Failed to map " << file_name << std::endl;
+        length = 0;
+        return false;
+    }
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (address != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(address);
+#else
+        munmap(const_cast<char*>(address), length);
+#endif
+    }
+    address = nullptr;
+    length = 0;
+    opened = false;
+}
+
+bool MappedFile::isOpen() const { return opened; }
+
+const char* MappedFile::data() const { return address; }
+
+std::size_t MappedFile::size() const { return length; }
+}  // namespace util
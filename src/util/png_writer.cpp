@@ -0,0 +1,248 @@
+#include "util/png_writer.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace util {
+namespace {
+// Bits are packed from the least significant end, as deflate requires
+class BitWriter final {
+ public:
+    explicit BitWriter(std::vector<unsigned char>& _out) : out(_out) {}
+    void put(std::uint32_t bits, int count) {
+        buffer |= bits << used;
+        used += count;
+        while (used >= 8) {
+            out.push_back(static_cast<unsigned char>(buffer));
+            buffer >>= 8;
+            used -= 8;
+        }
+    }
+    // Huffman codes are defined most significant bit first
+    void putCode(std::uint32_t code, int length) {
+        std::uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) reversed |= ((code >> i) & 1u) << (length - 1 - i);
+        put(reversed, length);
+    }
+    void flush() {
+        if (used > 0) out.push_back(static_cast<unsigned char>(buffer));
+        buffer = 0;
+        used = 0;
+    }
+
+ private:
+    std::vector<unsigned char>& out;
+    std::uint32_t buffer = 0;
+    int used = 0;
+};
+
+// Fixed literal/length code of RFC 1951 section 3.2.6
+void putLiteral(BitWriter& writer, int symbol) {
+    if (symbol <= 143) {
+        writer.putCode(0x30 + symbol, 8);
+    } else if (symbol <= 255) {
+        writer.putCode(0x190 + symbol - 144, 9);
+    } else if (symbol <= 279) {
+        writer.putCode(symbol - 256, 7);
+    } else {
+        writer.putCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+constexpr int lengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr int distanceBase[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                  33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                  1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr int distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8,
+                                   9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+void putMatch(BitWriter& writer, int length, int distance) {
+    int code = 28;
+    while (lengthBase[code] > length) --code;
+    putLiteral(writer, 257 + code);
+    writer.put(length - lengthBase[code], lengthExtra[code]);
+    code = 29;
+    while (distanceBase[code] > distance) --code;
+    writer.putCode(code, 5);
+    writer.put(distance - distanceBase[code], distanceExtra[code]);
+}
+
+// zlib stream with a single fixed Huffman block
+void deflate(const std::vector<unsigned char>& data, std::vector<unsigned char>& out) {
+    constexpr int windowSize = 32768;
+    constexpr int minMatch = 3;
+    constexpr int maxMatch = 258;
+    // Longer chains find slightly longer matches for much more time
+    constexpr int maxChain = 16;
+    constexpr int hashBits = 15;
+
+    out.push_back(0x78);
+    out.push_back(0x01);
+    BitWriter writer(out);
+    // Final block, fixed Huffman codes
+    writer.put(1, 1);
+    writer.put(1, 2);
+    const int size = static_cast<int>(data.size());
+    std::vector<int> head(1 << hashBits, -1);
+    std::vector<int> previous(windowSize, -1);
+    auto hashAt = [&data](int pos) {
+        const std::uint32_t value = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+        return static_cast<int>((value * 2654435761u) >> (32 - hashBits));
+    };
+    auto insert = [&](int pos) {
+        if (pos + minMatch > size) return;
+        const int hash = hashAt(pos);
+        previous[pos & (windowSize - 1)] = head[hash];
+        head[hash] = pos;
+    };
+    int pos = 0;
+    while (pos < size) {
+        int bestLength = 0, bestDistance = 0;
+        if (pos + minMatch <= size) {
+            const int limit = std::min(maxMatch, size - pos);
+            int candidate = head[hashAt(pos)];
+            for (int chain = 0; chain < maxChain && candidate >= 0 && pos - candidate < windowSize; ++chain) {
+                int length = 0;
+                while (length < limit && data[candidate + length] == data[pos + length]) ++length;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = pos - candidate;
+                    if (length == limit) break;
+                }
+                candidate = previous[candidate & (windowSize - 1)];
+            }
+        }
+        if (bestLength >= minMatch) {
+            putMatch(writer, bestLength, bestDistance);
+            for (int i = 0; i < bestLength; ++i) insert(pos + i);
+            pos += bestLength;
+        } else {
+            putLiteral(writer, data[pos]);
+            insert(pos);
+            ++pos;
+        }
+    }
+    putLiteral(writer, 256);
+    writer.flush();
+    // Adler-32 of the uncompressed data, big endian
+    std::uint32_t a = 1, b = 0;
+    for (int i = 0; i < size;) {
+        // Largest run that cannot overflow before the modulo
+        const int end = std::min(size, i + 5552);
+        for (; i < end; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    const std::uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<unsigned char>(adler >> shift));
+}
+
+std::uint32_t crc32(const unsigned char* data, std::size_t size, std::uint32_t crc = 0) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> result{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            result[n] = c;
+        }
+        return result;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void putChunk(std::vector<unsigned char>& png, const char* type, const std::vector<unsigned char>& data) {
+    const std::uint32_t length = static_cast<std::uint32_t>(data.size());
+    for (int shift = 24; shift >= 0; shift -= 8) png.push_back(static_cast<unsigned char>(length >> shift));
+    const std::size_t typeBegin = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    const std::uint32_t crc = crc32(png.data() + typeBegin, png.size() - typeBegin);
+    for (int shift = 24; shift >= 0; shift -= 8) png.push_back(static_cast<unsigned char>(crc >> shift));
+}
+
+int paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+}  // namespace
+
+bool encodePNG(const unsigned char* pixels, int width, int height, int channels, std::vector<unsigned char>& png) {
+    if (width <= 0 || height <= 0 || (channels != 3 && channels != 4)) {
+        std::cerr << "PNG encoder only takes non-empty RGB or RGBA images" << std::endl;
+        return false;
+    }
+    const int rowSize = width * channels;
+    // Every row starts with its filter type
+    std::vector<unsigned char> filtered(static_cast<std::size_t>(rowSize + 1) * height);
+    std::vector<unsigned char> candidate(rowSize);
+    const std::vector<unsigned char> zeroRow(rowSize, 0);
+    for (int y = 0; y < height; ++y) {
+        const unsigned char* row = pixels + static_cast<std::size_t>(y) * rowSize;
+        const unsigned char* above = y > 0 ? row - rowSize : zeroRow.data();
+        unsigned char* out = filtered.data() + static_cast<std::size_t>(y) * (rowSize + 1);
+        // Heuristic of the PNG specification: smallest sum of residuals as signed bytes
+        long bestSum = -1;
+        for (int filter = 0; filter < 5; ++filter) {
+            long sum = 0;
+            for (int x = 0; x < rowSize; ++x) {
+                const int left = x >= channels ? row[x - channels] : 0;
+                const int upLeft = x >= channels ? above[x - channels] : 0;
+                int predicted = 0;
+                switch (filter) {
+                    case 1: predicted = left; break;
+                    case 2: predicted = above[x]; break;
+                    case 3: predicted = (left + above[x]) / 2; break;
+                    case 4: predicted = paeth(left, above[x], upLeft); break;
+                    default: break;
+                }
+                candidate[x] = static_cast<unsigned char>(row[x] - predicted);
+                sum += std::abs(static_cast<signed char>(candidate[x]));
+            }
+            if (bestSum < 0 || sum < bestSum) {
+                bestSum = sum;
+                out[0] = static_cast<unsigned char>(filter);
+                std::memcpy(out + 1, candidate.data(), rowSize);
+            }
+        }
+    }
+    static constexpr unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    png.assign(signature, signature + 8);
+    std::vector<unsigned char> header;
+    for (const int value : {width, height}) {
+        for (int shift = 24; shift >= 0; shift -= 8) header.push_back(static_cast<unsigned char>(value >> shift));
+    }
+    // 8 bits per channel, truecolor with or without alpha, no interlacing
+    header.insert(header.end(), {8, static_cast<unsigned char>(channels == 4 ? 6 : 2), 0, 0, 0});
+    putChunk(png, "IHDR", header);
+    std::vector<unsigned char> compressed;
+    deflate(filtered, compressed);
+    putChunk(png, "IDAT", compressed);
+    putChunk(png, "IEND", {});
+    return true;
+}
+
+bool writePNG(const fs::path& file_name, const unsigned char* pixels, int width, int height, int channels) {
+    std::vector<unsigned char> png;
+    if (!encodePNG(pixels, width, height, channels, png)) return false;
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to open " << file_name << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+}  // namespace util
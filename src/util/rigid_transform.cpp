@@ -0,0 +1,36 @@
+#include "util/rigid_transform.h"
+
+namespace util {
+RigidTransform::RigidTransform() noexcept {}
+
+RigidTransform::RigidTransform(const Eigen::Quaterniond& _rotation, const Eigen::Vector3d& _translation) noexcept
+    : rotation(_rotation), translation(_translation) {}
+
+RigidTransform RigidTransform::Identity() { return RigidTransform(); }
+
+RigidTransform RigidTransform::operator*(const RigidTransform& other) const {
+    return RigidTransform(rotation * other.rotation, rotation * other.translation + translation);
+}
+
+Eigen::Vector3d RigidTransform::operator*(const Eigen::Vector3d& point) const { return rotation * point + translation; }
+
+Eigen::Vector4d RigidTransform::operator*(const Eigen::Vector4d& vector) const {
+    Eigen::Vector4d result;
+    result.head<3>() = rotation * vector.head<3>() + vector[3] * translation;
+    result[3] = vector[3];
+    return result;
+}
+
+RigidTransform RigidTransform::inverse() const {
+    // Unit quaternion, so the conjugate is the inverse
+    const Eigen::Quaterniond inverse_rotation = rotation.conjugate();
+    return RigidTransform(inverse_rotation, -(inverse_rotation * translation));
+}
+
+Eigen::AffineCompact3d RigidTransform::toAffine() const {
+    Eigen::AffineCompact3d affine;
+    affine.linear() = rotation.toRotationMatrix();
+    affine.translation() = translation;
+    return affine;
+}
+}  // namespace util
@@ -0,0 +1,99 @@
+#include "util/text_writer.h"
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace util {
+namespace {
+constexpr std::size_t buffer_size = 1 << 20;
+// Longest std::to_chars output of a double ("-2.2250738585072014e-308") or an int
+constexpr std::size_t max_number_length = 32;
+}  // namespace
+
+TextWriter::TextWriter() noexcept : buffer(buffer_size) {}
+
+TextWriter::TextWriter(const fs::path& file_name) noexcept : buffer(buffer_size) { open(file_name); }
+
+TextWriter::TextWriter(TextWriter&& other) noexcept
+    : stream(std::move(other.stream)),
+      buffer(std::move(other.buffer)),
+      used(std::exchange(other.used, 0)),
+      failed(std::exchange(other.failed, false)) {}
+
+TextWriter::~TextWriter() { close(); }
+
+TextWriter& TextWriter::operator=(TextWriter&& other) noexcept {
+    if (this != &other) {
+        close();
+        stream = std::move(other.stream);
+        buffer = std::move(other.buffer);
+        used = std::exchange(other.used, 0);
+        failed = std::exchange(other.failed, false);
+    }
+    return *this;
+}
+
+bool TextWriter::open(const fs::path& file_name) {
+    close();
+    stream.open(file_name, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        std::cerr << "Failed to create " << file_name << std::endl;
+        return false;
+    }
+    used = 0;
+    failed = false;
+    return true;
+}
+
+bool TextWriter::close() {
+    if (!stream.is_open()) return !failed;
+    flush();
+    stream.close();
+    failed = failed || stream.fail();
+    return !failed;
+}
+
+bool TextWriter::isOpen() const { return stream.is_open(); }
+
+TextWriter& TextWriter::write(std::string_view text) {
+    if (buffer.size() - used < text.size()) {
+        flush();
+        // Text longer than the whole buffer goes to the file directly
+        if (text.size() > buffer.size()) {
+            stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+            failed = failed || stream.fail();
+            return *this;
+        }
+    }
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+    return *this;
+}
+
+TextWriter& TextWriter::write(double value) {
+    if (buffer.size() - used < max_number_length) flush();
+    used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data();
+    return *this;
+}
+
+TextWriter& TextWriter::write(int value) {
+    if (buffer.size() - used < max_number_length) flush();
+    used = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data();
+    return *this;
+}
+
+TextWriter& TextWriter::put(char c) {
+    if (used == buffer.size()) flush();
+    buffer[used++] = c;
+    return *this;
+}
+
+void TextWriter::flush() {
+    if (used == 0) return;
+    stream.write(buffer.data(), static_cast<std::streamsize>(used));
+    failed = failed || stream.fail();
+    used = 0;
+}
+}  // namespace util
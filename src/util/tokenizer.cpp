@@ -0,0 +1,130 @@
+#include "util/tokenizer.h"
+
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+
+namespace util {
+namespace {
+// Plain decimals (optional sign, at most 15 digits, no exponent) as mocap files write them.
+// The digits fit exactly in a double and so does 10^k for k <= 22, so one division is correctly rounded
+// and gives the same value as std::from_chars (Clinger's fast path). Returns false for anything else.
+bool parseSimpleDecimal(const char* begin, const char* end, double& value) {
+    constexpr double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const bool negative = begin != end && *begin == '-';
+    if (negative) ++begin;
+    std::uint64_t mantissa = 0;
+    int digits = 0, fraction_digits = 0;
+    bool fraction = false;
+    for (const char* c = begin; c != end; ++c) {
+        if (*c >= '0' && *c <= '9') {
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*c - '0');
+            ++digits;
+            if (fraction) ++fraction_digits;
+        } else if (*c == '.' && !fraction) {
+            fraction = true;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0 || digits > 15) return false;
+    const double result = static_cast<double>(mantissa) / powers_of_ten[fraction_digits];
+    value = negative ? -result : result;
+    return true;
+}
+// std::from_chars rejects a leading '+' that istream accepted, so numbers are parsed without it
+std::string_view withoutPlus(std::string_view token) {
+    if (token.size() > 1 && token[0] == '+' && token[1] != '+' && token[1] != '-') token.remove_prefix(1);
+    return token;
+}
+}  // namespace
+
+Tokenizer::Tokenizer(const char* begin, const char* _end, const std::string& _name, int first_line) noexcept
+    : current(begin), end(_end), name(_name), line_begin(begin), line_number(first_line), token_line(first_line) {}
+
+bool Tokenizer::eof() {
+    skipWhitespace(false);
+    return current == end;
+}
+
+std::string_view Tokenizer::next() {
+    skipWhitespace(false);
+    return readToken();
+}
+
+std::string_view Tokenizer::nextInLine() {
+    skipWhitespace(true);
+    return readToken();
+}
+
+bool Tokenizer::next(double& value) {
+    const std::string_view token = next();
+    const std::string_view number = withoutPlus(token);
+    if (parseSimpleDecimal(number.data(), number.data() + number.size(), value)) return true;
+    const auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (number.empty() || ec != std::errc() || ptr != number.data() + number.size()) {
+        error("expected a number but got \"" + std::string(token) + "\"");
+        return false;
+    }
+    return true;
+}
+
+bool Tokenizer::next(int& value) {
+    const std::string_view token = next();
+    const std::string_view number = withoutPlus(token);
+    const auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+    if (number.empty() || ec != std::errc() || ptr != number.data() + number.size()) {
+        error("expected an integer but got \"" + std::string(token) + "\"");
+        return false;
+    }
+    return true;
+}
+
+std::string_view Tokenizer::line() {
+    token_line = line_number;
+    token_column = static_cast<int>(current - line_begin) + 1;
+    const char* begin = current;
+    while (current != end && *current != '\n') ++current;
+    const char* last = current;
+    if (last != begin && *(last - 1) == '\r') --last;
+    if (current != end) {
+        ++current;
+        ++line_number;
+        line_begin = current;
+    }
+    return std::string_view(begin, last - begin);
+}
+
+void Tokenizer::skipLine() { line(); }
+
+void Tokenizer::error(const std::string& message) const {
+    std::cerr << name << ":" << token_line << ":" << token_column << ": " << message << std::endl;
+}
+
+int Tokenizer::getLine() const { return token_line; }
+
+int Tokenizer::getColumn() const { return token_column; }
+
+const char* Tokenizer::position() const { return current; }
+
+void Tokenizer::skipWhitespace(bool stop_at_newline) {
+    // Space and every control character count as whitespace, a single compare per byte
+    while (current != end && static_cast<unsigned char>(*current) <= ' ') {
+        if (*current == '\n') {
+            if (stop_at_newline) return;
+            ++line_number;
+            line_begin = current + 1;
+        }
+        ++current;
+    }
+}
+
+std::string_view Tokenizer::readToken() {
+    token_line = line_number;
+    token_column = static_cast<int>(current - line_begin) + 1;
+    const char* begin = current;
+    while (current != end && static_cast<unsigned char>(*current) > ' ') ++current;
+    return std::string_view(begin, current - begin);
+}
+}  // namespace util
@@ -0,0 +1,120 @@
+/*
+Regression test for acclaim::readAMCFile: the same file parsed on any number of threads gives the same clip.
+
+Usage: AMCParserTest <asf file> <amc file>
+
+The frame of the AMC file is repeated, with the frame number as root TX, into temporary files whose frame counts
+do not split evenly into per-thread chunks. Every row of the single thread clip must hold its own frame number,
+then every file is parsed with 2 to max_threads threads and compared against the single thread clip row by row.
+*/
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "acclaim/amc_parser.h"
+#include "acclaim/motion_clip.h"
+#include "acclaim/skeleton.h"
+#include "util/filesystem.h"
+
+namespace {
+constexpr int max_threads = 12;
+
+// Read the bone lines of the first frame in an AMC file
+bool readFirstFrame(const util::fs::path &file_name, std::string &header, std::string &frame) {
+    std::ifstream file(file_name);
+    if (!file) return false;
+    std::string line;
+    bool in_frame = false;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        const bool frame_line = line[0] >= '0' && line[0] <= '9';
+        if (frame_line && in_frame) break;
+        if (frame_line) {
+            in_frame = true;
+        } else if (in_frame) {
+            frame += line + '\n';
+        } else {
+            header += line + '\n';
+        }
+    }
+    return in_frame && !frame.empty();
+}
+
+// Repeat the frame with its root TX replaced by the frame number, so a row parsed into the wrong place differs
+bool writeRepeatedFrames(const util::fs::path &file_name, const std::string &header, const std::string &frame,
+                         int frame_num) {
+    const std::size_t root = frame.compare(0, 5, "root ") == 0 ? 0 : frame.find("\nroot ");
+    if (root == std::string::npos) return false;
+    const std::size_t tx = frame.find_first_not_of(' ', frame.find(' ', root + 1));
+    const std::size_t tx_end = frame.find_first_of(" \n", tx);
+    if (tx == std::string::npos || tx_end == std::string::npos) return false;
+    std::ofstream file(file_name);
+    file << header;
+    for (int i = 1; i <= frame_num; ++i) {
+        file << i << '\n' << frame.substr(0, tx) << i << frame.substr(tx_end);
+    }
+    return static_cast<bool>(file);
+}
+
+// Every row carries the root TX written by writeRepeatedFrames(), scaled like all root translations
+bool framesInOrder(const acclaim::MotionClip &clip, const acclaim::Skeleton &skeleton) {
+    const int tx = clip.getLayout().getChannelIndex(acclaim::Skeleton::root_idx(), acclaim::ChannelType::TX);
+    for (int i = 0; i < clip.getFrameNum(); ++i) {
+        if (clip.getFrameData(i)[tx] != (i + 1) * skeleton.getScale()) return false;
+    }
+    return true;
+}
+
+bool sameClip(const acclaim::MotionClip &lhs, const acclaim::MotionClip &rhs) {
+    if (lhs.getFrameNum() != rhs.getFrameNum() || lhs.getChannelNum() != rhs.getChannelNum()) return false;
+    for (int i = 0; i < lhs.getFrameNum(); ++i) {
+        const std::size_t row_size = sizeof(double) * lhs.getChannelNum();
+        if (std::memcmp(lhs.getFrameData(i), rhs.getFrameData(i), row_size) != 0) return false;
+    }
+    return true;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <asf file> <amc file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    acclaim::Skeleton skeleton(argv[1], 0.2);
+    std::string header, frame;
+    if (!readFirstFrame(argv[2], header, frame)) {
+        std::cerr << "No frame in " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const util::fs::path file_name = util::fs::temp_directory_path() / "amc_parser_test.amc";
+    bool passed = true;
+    // Parsers read 64 frames per chunk, these leave the last threads of a round-up split without chunks
+    for (int frame_num : {1, 63, 64, 65, 300, 513, 545, 576, 1000}) {
+        if (!writeRepeatedFrames(file_name, header, frame, frame_num)) {
+            std::cerr << "Cannot write " << file_name.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        acclaim::MotionClip expected{acclaim::ChannelLayout(skeleton)};
+        if (!acclaim::readAMCFile(file_name, skeleton, expected, 1) || expected.getFrameNum() != frame_num) {
+            std::cerr << frame_num << " frames: single thread parse failed" << std::endl;
+            passed = false;
+            continue;
+        }
+        if (!framesInOrder(expected, skeleton)) {
+            std::cerr << frame_num << " frames: single thread rows out of order" << std::endl;
+            passed = false;
+        }
+        for (int thread_num = 2; thread_num <= max_threads; ++thread_num) {
+            acclaim::MotionClip clip{acclaim::ChannelLayout(skeleton)};
+            if (!acclaim::readAMCFile(file_name, skeleton, clip, thread_num) || !sameClip(expected, clip)) {
+                std::cerr << frame_num << " frames: " << thread_num << " threads differ from 1 thread" << std::endl;
+                passed = false;
+            }
+        }
+    }
+    util::fs::remove(file_name);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
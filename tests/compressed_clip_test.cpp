@@ -0,0 +1,105 @@
+/*
+Regression test for acclaim::CompressedClip: every decoded frame stays within the world-space tolerance.
+
+Usage: CompressedClipTest <asf file>
+
+A synthetic clip moves every channel of the skeleton over a wide range, so that the tightest tolerances need
+more than 16-bit keys. Each frame is decoded, both poses are evaluated with forward kinematics and no bone end
+may be further from the original than the tolerance the clip was compressed with.
+A second clip travels far with small rotations, only its root translation channels may use 32-bit keys.
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "acclaim/compressed_clip.h"
+#include "acclaim/motion_clip.h"
+#include "acclaim/pose.h"
+#include "acclaim/posture.h"
+#include "acclaim/skeleton.h"
+#include "simulation/kinematics.h"
+
+namespace {
+constexpr int frame_num = 600;
+
+// Smooth motion with a little jitter, root translation spans about 2 * translation units and rotations about
+// 2 * rotation degrees
+acclaim::MotionClip syntheticClip(const acclaim::Skeleton &skeleton, double translation, double rotation) {
+    acclaim::MotionClip clip{acclaim::ChannelLayout(skeleton)};
+    const acclaim::ChannelLayout &layout = clip.getLayout();
+    clip.resize(frame_num);
+    for (int frame = 0; frame < frame_num; ++frame) {
+        double *row = clip.getFrameData(frame);
+        for (int channel = 0; channel < layout.getChannelNum(); ++channel) {
+            const double amplitude =
+                layout.getChannelType(channel) <= acclaim::ChannelType::TZ ? translation : rotation;
+            row[channel] = amplitude * std::sin(0.004 * frame * (channel % 7 + 1) + channel) +
+                           0.01 * amplitude * std::sin(0.05 * frame * (channel % 5 + 2));
+        }
+    }
+    return clip;
+}
+
+// Largest distance between matching bone ends of two poses
+double maxDistance(const acclaim::Pose &lhs, const acclaim::Pose &rhs) {
+    double distance = 0.0;
+    for (std::size_t i = 0; i < lhs.end_positions.size(); ++i) {
+        distance = std::max(distance, (lhs.end_positions[i] - rhs.end_positions[i]).norm());
+    }
+    return distance;
+}
+
+// Decode every frame and compare bone ends against the original, false if any is further than tolerance
+bool checkBound(const acclaim::MotionClip &clip, const acclaim::CompressedClip &compressed,
+                const acclaim::Skeleton &skeleton, double tolerance) {
+    const acclaim::Bone *root = skeleton.getBonePointer(acclaim::Skeleton::root_idx());
+    const int bone_num = skeleton.getBoneNum();
+    acclaim::Posture posture(bone_num), decoded_posture(bone_num);
+    acclaim::Pose pose(bone_num), decoded_pose(bone_num);
+    std::vector<double> row(clip.getChannelNum());
+    double error = 0.0;
+    for (int frame = 0; frame < clip.getFrameNum(); ++frame) {
+        clip.getPosture(frame).toPosture(posture);
+        kinematics::forwardSolver(posture, root, pose);
+        compressed.decode(frame, row.data(), decoded_posture);
+        kinematics::forwardSolver(decoded_posture, root, decoded_pose);
+        error = std::max(error, maxDistance(pose, decoded_pose));
+    }
+    std::cout << "tolerance " << tolerance << ": " << compressed.getKeyNum() << " keys, "
+              << compressed.getMemorySize() << " bytes, max error " << error << std::endl;
+    // Only floating point rounding may go past the tolerance
+    if (error > tolerance * (1.0 + 1e-9) + 1e-12) {
+        std::cerr << "tolerance " << tolerance << " exceeded by " << error - tolerance << std::endl;
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <asf file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const acclaim::Skeleton skeleton(argv[1], 0.2);
+    bool passed = true;
+    const acclaim::MotionClip clip = syntheticClip(skeleton, 60.0, 170.0);
+    for (double tolerance : {0.1, 0.01, 0.001, 1e-5}) {
+        passed = checkBound(clip, acclaim::CompressedClip(clip, skeleton, tolerance), skeleton, tolerance) && passed;
+    }
+    // 16-bit steps of a 2000 unit walk are far coarser than 0.01, those of 60 degree rotations are not
+    const acclaim::MotionClip walk = syntheticClip(skeleton, 1000.0, 30.0);
+    const acclaim::CompressedClip compressed(walk, skeleton, 0.01);
+    passed = checkBound(walk, compressed, skeleton, 0.01) && passed;
+    const acclaim::ChannelLayout &layout = walk.getLayout();
+    for (int channel = 0; channel < layout.getChannelNum(); ++channel) {
+        const bool translation = layout.getChannelType(channel) <= acclaim::ChannelType::TZ;
+        if (compressed.isWideChannel(channel) != translation) {
+            std::cerr << "channel " << channel << " is " << (translation ? "not " : "") << "widened" << std::endl;
+            passed = false;
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,134 @@
+/*
+Regression test for the kernels FKGenerator emits: they agree with the generic kinematics solvers.
+
+Usage: GeneratedSolverTest <asf file> <scale>
+
+The skeleton and scale must be the ones the solver linked into this test was generated for. Random postures are
+evaluated with the generated and the generic forward kinematics, then the Jacobian of every start/end chain is
+built both ways, and a few IK solves are run with and without the generated kernels. All results must match up to
+rounding.
+*/
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <utility>
+
+#include "acclaim/pose.h"
+#include "acclaim/posture.h"
+#include "acclaim/skeleton.h"
+#include "simulation/kinematics.h"
+
+namespace {
+constexpr int posture_num = 50;
+constexpr double tolerance = 1e-10;
+
+// Random angles on every rotational DOF, channels without DOF stay zero as in parsed motions
+void randomPosture(const acclaim::Skeleton &skeleton, std::mt19937 &random, acclaim::Posture &posture) {
+    std::uniform_real_distribution<double> angle(-120.0, 120.0), position(-20.0, 20.0);
+    for (int i = 0; i < skeleton.getBoneNum(); ++i) {
+        const acclaim::Bone *bone = skeleton.getBonePointer(i);
+        posture.bone_rotations[i] = {bone->dofrx ? angle(random) : 0.0, bone->dofry ? angle(random) : 0.0,
+                                     bone->dofrz ? angle(random) : 0.0, 0.0};
+    }
+    posture.bone_translations[acclaim::Skeleton::root_idx()] = {position(random), position(random), position(random),
+                                                                0.0};
+}
+
+double poseDistance(const acclaim::Pose &lhs, const acclaim::Pose &rhs) {
+    double distance = 0.0;
+    for (std::size_t i = 0; i < lhs.transforms.size(); ++i) {
+        distance = std::max(distance, (lhs.end_positions[i] - rhs.end_positions[i]).norm());
+        distance = std::max(distance, (lhs.transforms[i].translation - rhs.transforms[i].translation).norm());
+        distance = std::max(distance, (lhs.transforms[i].rotation.toRotationMatrix() -
+                                       rhs.transforms[i].rotation.toRotationMatrix()).cwiseAbs().maxCoeff());
+    }
+    return distance;
+}
+
+// Number of bones inverseJacobianIKSolver puts in the chain from end up to start
+int chainLength(const acclaim::Bone *start, const acclaim::Bone *end) {
+    int bone_num = 1;
+    for (const acclaim::Bone *bone = end; bone != start && bone->parent != nullptr; bone = bone->parent) ++bone_num;
+    return bone_num;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <asf file> <scale>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const acclaim::Skeleton skeleton(argv[1], std::atof(argv[2]));
+    const kinematics::GeneratedSolver *generated = kinematics::findGeneratedSolver(skeleton.getFingerprint());
+    if (generated == nullptr || generated->bone_num != skeleton.getBoneNum()) {
+        std::cerr << "No generated solver for " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const int bone_num = skeleton.getBoneNum();
+    const acclaim::Bone *root = skeleton.getBonePointer(acclaim::Skeleton::root_idx());
+    std::mt19937 random(2024);
+    acclaim::Posture posture(bone_num);
+    acclaim::Pose expected(bone_num), pose(bone_num);
+    double fk_error = 0.0, jacobian_error = 0.0;
+    for (int i = 0; i < posture_num; ++i) {
+        randomPosture(skeleton, random, posture);
+        kinematics::forwardSolver(posture, root, expected);
+        generated->forwardSolver(posture, pose);
+        fk_error = std::max(fk_error, poseDistance(expected, pose));
+
+        const Eigen::Vector4d target_pos(1.0, 2.0, -3.0, 0.0);
+        for (int end = 0; end < bone_num; ++end) {
+            for (int start = 0; start < bone_num; ++start) {
+                const int length = chainLength(skeleton.getBonePointer(start), skeleton.getBonePointer(end));
+                Eigen::Matrix4Xd generic = Eigen::Matrix4Xd::Zero(4, 3 * length);
+                Eigen::Matrix4Xd unrolled = Eigen::Matrix4Xd::Zero(4, 3 * length);
+                kinematics::chainJacobian(skeleton.getBonePointer(end), length, expected, target_pos, generic);
+                generated->chainJacobians[end * bone_num + start](expected, target_pos, unrolled);
+                jacobian_error = std::max(jacobian_error, (generic - unrolled).cwiseAbs().maxCoeff());
+            }
+        }
+    }
+    std::cout << "forward kinematics error " << fk_error << ", Jacobian error " << jacobian_error << std::endl;
+    bool passed = true;
+    if (fk_error > tolerance || jacobian_error > tolerance) {
+        std::cerr << "Generated kernels differ from the generic solvers" << std::endl;
+        passed = false;
+    }
+
+    // Whole IK solves from a random posture towards the end of the same chain re-posed, so the target is reachable
+    const std::pair<const char *, const char *> chains[] = {
+        {"lhumerus", "lhand"}, {"rfemur", "rfoot"}, {"lowerback", "head"}, {"thorax", "rthumb"}};
+    for (const auto &chain : chains) {
+        const acclaim::Bone *start = skeleton.getBonePointer(chain.first);
+        const acclaim::Bone *end = skeleton.getBonePointer(chain.second);
+        if (start == nullptr || end == nullptr) {
+            std::cerr << "No bone " << chain.first << " or " << chain.second << std::endl;
+            passed = false;
+            continue;
+        }
+        acclaim::Posture generic_posture(bone_num), target_posture(bone_num);
+        randomPosture(skeleton, random, generic_posture);
+        randomPosture(skeleton, random, target_posture);
+        target_posture.bone_translations = generic_posture.bone_translations;
+        for (const acclaim::Bone *bone = start->parent; bone != nullptr; bone = bone->parent) {
+            target_posture.bone_rotations[bone->idx] = generic_posture.bone_rotations[bone->idx];
+        }
+        kinematics::forwardSolver(target_posture, root, expected);
+        const Eigen::Vector4d target_pos = expected.end_positions[end->idx];
+        acclaim::Posture unrolled_posture(generic_posture);
+        const bool generic_done = kinematics::inverseJacobianIKSolver(target_pos, start, end, generic_posture, pose);
+        const bool unrolled_done =
+            kinematics::inverseJacobianIKSolver(target_pos, start, end, unrolled_posture, pose, generated);
+        double error = 0.0;
+        for (int i = 0; i < bone_num; ++i) {
+            error = std::max(error, (generic_posture.bone_rotations[i] - unrolled_posture.bone_rotations[i]).norm());
+        }
+        std::cout << chain.first << " -> " << chain.second << ": IK posture error " << error << std::endl;
+        if (!generic_done || !unrolled_done || error > 1e-6) {
+            std::cerr << chain.first << " -> " << chain.second << ": IK solves differ or fail" << std::endl;
+            passed = false;
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,102 @@
+/*
+Regression test for util::encodePNG: every encoded image decodes back to the exact same pixels.
+
+Usage: PNGWriterTest
+
+Random, gradient and periodic RGB/RGBA images of odd widths are encoded and decoded with stb_image. Several
+images are larger than the 32 KiB deflate window, and the periodic ones repeat their rows just inside it, so
+both the longest matches and the farthest distances are exercised.
+*/
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/png_writer.h"
+
+#define STBI_ONLY_PNG
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#undef STB_IMAGE_IMPLEMENTATION
+#undef STBI_ONLY_PNG
+
+namespace {
+enum class Pattern { Random, Gradient, Periodic };
+
+std::vector<unsigned char> makeImage(Pattern pattern, int width, int height, int channels, std::mt19937 &random) {
+    const int row_size = width * channels;
+    std::vector<unsigned char> pixels(static_cast<std::size_t>(row_size) * height);
+    std::uniform_int_distribution<int> byte(0, 255);
+    // Rows repeat with the largest period that still fits the 32 KiB window, counting filter bytes
+    const int period = std::max(1, 32768 / (row_size + 1));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < row_size; ++x) {
+            unsigned char &value = pixels[static_cast<std::size_t>(y) * row_size + x];
+            switch (pattern) {
+                case Pattern::Random:
+                    value = static_cast<unsigned char>(byte(random));
+                    break;
+                case Pattern::Gradient:
+                    value = static_cast<unsigned char>((x / channels) * (x % channels + 1) + y * 3);
+                    break;
+                case Pattern::Periodic:
+                    value = y < period ? static_cast<unsigned char>(byte(random))
+                                       : pixels[static_cast<std::size_t>(y - period) * row_size + x];
+                    break;
+            }
+        }
+    }
+    return pixels;
+}
+
+bool roundTrip(const std::string &name, const std::vector<unsigned char> &pixels, int width, int height,
+               int channels) {
+    std::vector<unsigned char> png;
+    if (!util::encodePNG(pixels.data(), width, height, channels, png)) {
+        std::cerr << name << ": encoding failed" << std::endl;
+        return false;
+    }
+    int decoded_width = 0, decoded_height = 0, decoded_channels = 0;
+    stbi_uc *decoded = stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &decoded_width,
+                                             &decoded_height, &decoded_channels, 0);
+    if (decoded == nullptr) {
+        std::cerr << name << ": decoding failed, " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+    const bool same = decoded_width == width && decoded_height == height && decoded_channels == channels &&
+                      std::memcmp(decoded, pixels.data(), pixels.size()) == 0;
+    stbi_image_free(decoded);
+    if (!same) {
+        std::cerr << name << ": decoded pixels differ" << std::endl;
+        return false;
+    }
+    std::cout << name << ": " << pixels.size() << " bytes encoded to " << png.size() << std::endl;
+    return true;
+}
+}  // namespace
+
+int main() {
+    struct Size {
+        int width, height;
+    };
+    const Size sizes[] = {{1, 1}, {3, 5}, {17, 9}, {101, 67}, {257, 129}, {333, 211}};
+    const char *pattern_names[] = {"random", "gradient", "periodic"};
+    std::mt19937 random(49);
+    bool passed = true;
+    for (const Size &size : sizes) {
+        for (int channels : {3, 4}) {
+            for (Pattern pattern : {Pattern::Random, Pattern::Gradient, Pattern::Periodic}) {
+                const std::string name = std::string(pattern_names[static_cast<int>(pattern)]) + " " +
+                                         std::to_string(size.width) + "x" + std::to_string(size.height) + "x" +
+                                         std::to_string(channels);
+                const std::vector<unsigned char> pixels =
+                    makeImage(pattern, size.width, size.height, channels, random);
+                passed = roundTrip(name, pixels, size.width, size.height, channels) && passed;
+            }
+        }
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}